@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <assimp/scene.h>
 #include <learnopengl/bone.h>
+#include <learnopengl/compressed_clip.h>
 #include <functional>
 #include <learnopengl/animdata.h>
 #include <learnopengl/model_animation.h>
@@ -17,12 +18,40 @@ struct AssimpNodeData
 	std::vector<AssimpNodeData> children;
 };
 
+/*Node of the flattened skeleton. Parents always come before their children.*/
+struct SkeletonNode
+{
+	glm::mat4 transformation;
+	glm::mat4 offset;
+
+	/*transformation split in translation, rotation and scale, used when blending nodes a clip doesn't animate*/
+	BonePose bindPose;
+
+	/*-1 for the root node*/
+	int parentIndex;
+
+	/*index in the bones (animated channels) of the animation, -1 if the node is not animated*/
+	int channelIndex;
+
+	/*index in finalBoneMatrices, -1 if no vertex is bound to the node*/
+	int boneIndex;
+
+	/*links from the node down to the deepest leaf of its subtree, 0 for leaves (finger tips, head top, toes...)*/
+	int leafDistance;
+};
+
 class Animation
 {
 public:
 	Animation() = default;
 
 	Animation(const std::string& animationPath, Model* model)
+		: Animation(animationPath, model->GetBoneInfoMap(), model->GetBoneCount())
+	{
+	}
+
+	/*Load the animation without a model, e.g. for offline processing. Channels are assigned the next free bone ids.*/
+	Animation(const std::string& animationPath, std::map<std::string, BoneInfo>& boneInfoMap, int& boneCount)
 	{
 		Assimp::Importer importer;
 		const aiScene* scene = importer.ReadFile(animationPath, aiProcess_Triangulate);
@@ -33,7 +62,15 @@ public:
 		aiMatrix4x4 globalTransformation = scene->mRootNode->mTransformation;
 		globalTransformation = globalTransformation.Inverse();
 		ReadHierarchyData(m_RootNode, scene->mRootNode);
-		ReadMissingBones(animation, *model);
+		ReadMissingBones(animation, boneInfoMap, boneCount);
+		FlattenHierarchy(m_RootNode, -1);
+
+		//children come after their parent, so walking backwards visits a whole subtree before its root
+		for (size_t i = m_Skeleton.size(); i-- > 1;)
+		{
+			SkeletonNode& parent = m_Skeleton[m_Skeleton[i].parentIndex];
+			parent.leafDistance = std::max(parent.leafDistance, m_Skeleton[i].leafDistance + 1);
+		}
 	}
 
 	~Animation()
@@ -60,14 +97,218 @@ public:
 	{ 
 		return m_BoneInfoMap;
 	}
+	/*Evaluate the skeleton at animationTime. All the per instance state is passed in: one cursor per bone (channel),
+	scratch space for one global transform per skeleton node, and the output palette of GetBoneCount() matrices.
+	The animation itself isn't modified, so instances can be evaluated in parallel.
+	Nodes closer than minLeafDistance to the end of their chain keep their bind pose instead of being sampled, a cheap
+	level of detail for distant characters. Returns the number of channels sampled.*/
+	int Evaluate(float animationTime, BoneCursor* cursors, glm::mat4* globalTransforms, glm::mat4* finalBoneMatrices, int minLeafDistance = 0) const
+	{
+		int sampledChannels = 0;
+		for (size_t i = 0; i < m_Skeleton.size(); i++)
+		{
+			const SkeletonNode& node = m_Skeleton[i];
+			glm::mat4 nodeTransform = node.transformation;
+
+			if (node.channelIndex >= 0 && node.leafDistance >= minLeafDistance)
+			{
+				nodeTransform = SamplePose(node.channelIndex, animationTime, cursors[node.channelIndex]).ToMatrix();
+				sampledChannels++;
+			}
+
+			if (node.parentIndex >= 0)
+				globalTransforms[i] = globalTransforms[node.parentIndex] * nodeTransform;
+			else
+				globalTransforms[i] = nodeTransform;
+
+			if (node.boneIndex >= 0)
+				finalBoneMatrices[node.boneIndex] = globalTransforms[i] * node.offset;
+		}
+		return sampledChannels;
+	}
+
+	/*Number of channels Evaluate samples for a given minLeafDistance*/
+	int CountSampledChannels(int minLeafDistance = 0) const
+	{
+		int sampledChannels = 0;
+		for (const SkeletonNode& node : m_Skeleton)
+		{
+			if (node.channelIndex >= 0 && node.leafDistance >= minLeafDistance)
+				sampledChannels++;
+		}
+		return sampledChannels;
+	}
+
+	/*Local pose of a channel, from the compressed keys once Compress was called*/
+	BonePose SamplePose(int channel, float animationTime, BoneCursor& cursor) const
+	{
+		if (!m_CompressedClip.IsEmpty())
+			return m_CompressedClip.SamplePose(channel, animationTime, cursor);
+		return m_Bones[channel].SamplePose(animationTime, cursor);
+	}
+
+	/*Replace the keys by a reduced and quantized copy (see CompressedClip) and free the original ones.
+	positionTolerance bounds the model space position error of every node, which adds up the errors of all its
+	ancestors: the budget is split over the animated nodes of the deepest chain below each node, and its rotation and
+	scale share is divided by the distance to the farthest node they move. The error is then measured by sampling both
+	versions sampleCount times over the clip, and the channels above any node still out of tolerance are reduced again
+	with halved tolerances. rotationTolerance additionally bounds the local rotation error of every channel.*/
+	ClipCompressionReport Compress(float positionTolerance = 0.001f, float rotationTolerance = 0.0005f, int sampleCount = 1000)
+	{
+		ClipCompressionReport report;
+		if (!m_CompressedClip.IsEmpty())
+			return report;
+
+		//bind pose of every node in model space
+		std::vector<glm::mat4> bindGlobals(m_Skeleton.size());
+		for (size_t i = 0; i < m_Skeleton.size(); i++)
+		{
+			const SkeletonNode& node = m_Skeleton[i];
+			bindGlobals[i] = node.parentIndex >= 0 ? bindGlobals[node.parentIndex] * node.transformation : node.transformation;
+		}
+
+		//animated nodes from the root down to each node, then the most of them on any chain through the node
+		std::vector<int> chainDepth(m_Skeleton.size());
+		for (size_t i = 0; i < m_Skeleton.size(); i++)
+		{
+			const SkeletonNode& node = m_Skeleton[i];
+			chainDepth[i] = (node.parentIndex >= 0 ? chainDepth[node.parentIndex] : 0) + (node.channelIndex >= 0 ? 1 : 0);
+		}
+		//distance from each node to the farthest node of its subtree
+		std::vector<float> reach(m_Skeleton.size(), 0.0f);
+		for (size_t i = m_Skeleton.size(); i-- > 1;)
+		{
+			const int parentIndex = m_Skeleton[i].parentIndex;
+			chainDepth[parentIndex] = std::max(chainDepth[parentIndex], chainDepth[i]);
+			for (int ancestor = parentIndex; ancestor >= 0; ancestor = m_Skeleton[ancestor].parentIndex)
+				reach[ancestor] = std::max(reach[ancestor], glm::length(glm::vec3(bindGlobals[i][3]) - glm::vec3(bindGlobals[ancestor][3])));
+		}
+
+		std::vector<ChannelTolerance> tolerances(m_Bones.size());
+		for (size_t i = 0; i < m_Skeleton.size(); i++)
+		{
+			const SkeletonNode& node = m_Skeleton[i];
+			if (node.channelIndex < 0)
+				continue;
+
+			//a third of the node's share each for translation, rotation and scale; translations are scaled by the parent
+			const float share = positionTolerance / (3.0f * std::max(chainDepth[i], 1));
+			const float parentScale = node.parentIndex >= 0 ? glm::length(glm::vec3(bindGlobals[node.parentIndex][0])) : 1.0f;
+			ChannelTolerance& tolerance = tolerances[node.channelIndex];
+			tolerance.position = parentScale > 0.0f ? share / parentScale : share;
+			tolerance.rotation = reach[i] > 0.0f ? std::min(rotationTolerance, share / reach[i]) : rotationTolerance;
+			tolerance.scale = reach[i] > 0.0f ? share / reach[i] : share;
+		}
+
+		for (const Bone& bone : m_Bones)
+		{
+			report.rawSize += bone.GetKeySize();
+			report.rawKeyCount += bone.GetPositionKeys().size() + bone.GetRotationKeys().size() + bone.GetScaleKeys().size();
+		}
+
+		//quantization alone can exceed very small tolerances, so the number of passes is bounded
+		const int maxPasses = 8;
+		CompressedClip compressedClip;
+		std::vector<bool> tightened(m_Bones.size());
+		for (report.passes = 1; ; report.passes++)
+		{
+			compressedClip = CompressedClip(m_Bones, m_Duration, tolerances);
+			MeasureCompressionError(compressedClip, sampleCount, report);
+			if (report.passes == maxPasses)
+				break;
+
+			std::fill(tightened.begin(), tightened.end(), false);
+			bool withinTolerance = true;
+			for (size_t i = 0; i < m_Skeleton.size(); i++)
+			{
+				if (report.maxPositionError[i] <= positionTolerance)
+					continue;
+				withinTolerance = false;
+				for (int node = static_cast<int>(i); node >= 0; node = m_Skeleton[node].parentIndex)
+				{
+					const int channel = m_Skeleton[node].channelIndex;
+					if (channel < 0 || tightened[channel])
+						continue;
+					tightened[channel] = true;
+					tolerances[channel].position *= 0.5f;
+					tolerances[channel].rotation *= 0.5f;
+					tolerances[channel].scale *= 0.5f;
+				}
+			}
+			if (withinTolerance)
+				break;
+		}
+		report.compressedSize = compressedClip.GetSize();
+		report.compressedKeyCount = compressedClip.GetKeyCount();
+
+		m_CompressedClip = std::move(compressedClip);
+		for (Bone& bone : m_Bones)
+			bone.ReleaseKeys();
+		return report;
+	}
+
+	/*Per skeleton node weights selecting the subtree rooted at rootNodeName, e.g. "mixamorig_Spine" for an upper body layer*/
+	std::vector<float> CreateBoneMask(const std::string& rootNodeName, float weight = 1.0f) const
+	{
+		std::vector<float> mask(m_Skeleton.size(), 0.0f);
+		for (size_t i = 0; i < m_Skeleton.size(); i++)
+		{
+			const int parentIndex = m_Skeleton[i].parentIndex;
+			if (m_NodeNames[i] == rootNodeName || (parentIndex >= 0 && mask[parentIndex] != 0.0f))
+				mask[i] = weight;
+		}
+		return mask;
+	}
+
+	/*Index in GetBones() of the channel animating the node, -1 if the animation doesn't animate it*/
+	int FindChannelIndex(const std::string& nodeName)
+	{
+		Bone* bone = FindBone(nodeName);
+		return bone ? static_cast<int>(bone - m_Bones.data()) : -1;
+	}
+
+	inline const std::vector<SkeletonNode>& GetSkeleton() { return m_Skeleton; }
+	inline const std::string& GetNodeName(int nodeIndex) { return m_NodeNames[nodeIndex]; }
+	inline std::vector<Bone>& GetBones() { return m_Bones; }
+	inline const CompressedClip& GetCompressedClip() const { return m_CompressedClip; }
+	inline int GetBoneCount() { return m_BoneCount; }
 
 private:
-	void ReadMissingBones(const aiAnimation* animation, Model& model)
+	/*Largest model space position error and local rotation error of every node, compressed against raw keys*/
+	void MeasureCompressionError(const CompressedClip& compressedClip, int sampleCount, ClipCompressionReport& report) const
 	{
-		int size = animation->mNumChannels;
+		report.maxPositionError.assign(m_Skeleton.size(), 0.0f);
+		report.maxRotationError.assign(m_Skeleton.size(), 0.0f);
 
-		auto& boneInfoMap = model.GetBoneInfoMap();//getting m_BoneInfoMap from Model class
-		int& boneCount = model.GetBoneCount(); //getting the m_BoneCounter from Model class
+		std::vector<BoneCursor> rawCursors(m_Bones.size()), compressedCursors(m_Bones.size());
+		std::vector<glm::mat4> rawGlobals(m_Skeleton.size()), compressedGlobals(m_Skeleton.size());
+		for (int sample = 0; sample <= sampleCount; sample++)
+		{
+			const float animationTime = m_Duration * sample / sampleCount;
+			for (size_t i = 0; i < m_Skeleton.size(); i++)
+			{
+				const SkeletonNode& node = m_Skeleton[i];
+				glm::mat4 rawTransform = node.transformation, compressedTransform = node.transformation;
+				if (node.channelIndex >= 0)
+				{
+					const BonePose rawPose = m_Bones[node.channelIndex].SamplePose(animationTime, rawCursors[node.channelIndex]);
+					const BonePose compressedPose = compressedClip.SamplePose(node.channelIndex, animationTime, compressedCursors[node.channelIndex]);
+					report.maxRotationError[i] = std::max(report.maxRotationError[i], CompressedClip::GetAngle(rawPose.rotation, compressedPose.rotation));
+					rawTransform = rawPose.ToMatrix();
+					compressedTransform = compressedPose.ToMatrix();
+				}
+
+				rawGlobals[i] = node.parentIndex >= 0 ? rawGlobals[node.parentIndex] * rawTransform : rawTransform;
+				compressedGlobals[i] = node.parentIndex >= 0 ? compressedGlobals[node.parentIndex] * compressedTransform : compressedTransform;
+				const float distance = glm::length(glm::vec3(rawGlobals[i][3]) - glm::vec3(compressedGlobals[i][3]));
+				report.maxPositionError[i] = std::max(report.maxPositionError[i], distance);
+			}
+		}
+	}
+
+	void ReadMissingBones(const aiAnimation* animation, std::map<std::string, BoneInfo>& boneInfoMap, int& boneCount)
+	{
+		int size = animation->mNumChannels;
 
 		//reading channels(bones engaged in an animation and their keyframes)
 		for (int i = 0; i < size; i++)
@@ -85,6 +326,7 @@ private:
 		}
 
 		m_BoneInfoMap = boneInfoMap;
+		m_BoneCount = boneCount;
 	}
 
 	void ReadHierarchyData(AssimpNodeData& dest, const aiNode* src)
@@ -102,8 +344,54 @@ private:
 			dest.children.push_back(newData);
 		}
 	}
+	/*Split an affine transform without shear in translation, rotation and scale*/
+	static BonePose DecomposeTransform(const glm::mat4& transform)
+	{
+		BonePose pose;
+		pose.position = glm::vec3(transform[3]);
+		glm::mat3 rotation;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			pose.scale[axis] = glm::length(glm::vec3(transform[axis]));
+			rotation[axis] = pose.scale[axis] > 0.0f ? glm::vec3(transform[axis]) / pose.scale[axis] : glm::vec3(0.0f);
+		}
+		pose.rotation = glm::normalize(glm::quat_cast(rotation));
+		return pose;
+	}
+
+	/*Resolve the node names once so that evaluating the skeleton is a linear loop over indices*/
+	void FlattenHierarchy(const AssimpNodeData& node, int parentIndex)
+	{
+		SkeletonNode flatNode;
+		flatNode.transformation = node.transformation;
+		flatNode.offset = glm::mat4(1.0f);
+		flatNode.bindPose = DecomposeTransform(node.transformation);
+		flatNode.parentIndex = parentIndex;
+		flatNode.channelIndex = FindChannelIndex(node.name);
+		flatNode.boneIndex = -1;
+		flatNode.leafDistance = 0;
+
+		auto boneInfo = m_BoneInfoMap.find(node.name);
+		if (boneInfo != m_BoneInfoMap.end())
+		{
+			flatNode.boneIndex = boneInfo->second.id;
+			flatNode.offset = boneInfo->second.offset;
+		}
+
+		const int index = static_cast<int>(m_Skeleton.size());
+		m_Skeleton.push_back(flatNode);
+		m_NodeNames.push_back(node.name);
+
+		for (int i = 0; i < node.childrenCount; i++)
+			FlattenHierarchy(node.children[i], index);
+	}
+
 	float m_Duration;
 	int m_TicksPerSecond;
+	int m_BoneCount = 0;
+	std::vector<SkeletonNode> m_Skeleton;
+	std::vector<std::string> m_NodeNames;
+	CompressedClip m_CompressedClip;
 	std::vector<Bone> m_Bones;
 	AssimpNodeData m_RootNode;
 	std::map<std::string, BoneInfo> m_BoneInfoMap;
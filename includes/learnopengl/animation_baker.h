@@ -0,0 +1,277 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <learnopengl/animation.h>
+#include <learnopengl/bone.h>
+#include <learnopengl/cpu_skinning.h>
+#include <learnopengl/model_animation.h>
+
+enum class BakeMode : std::uint32_t
+{
+	/*the palette of every frame, 4 texels (columns) per bone, skinned by the vertex shader*/
+	BoneMatrices,
+
+	/*the skinned position of every vertex of every frame, 1 texel per vertex, no skinning left to do*/
+	VertexPositions
+};
+
+/*An animation sampled at a fixed rate into a vertex animation texture.
+The frames are stored one after the other as RGBA32F texels, in rows of TEXTURE_WIDTH texels: element e of
+frame f (bone column or vertex) is texel f * texelsPerFrame + e. A shader playing the bake only needs the
+texture, texelsPerFrame, frameCount and frameRate, so every instance can play it at its own time.
+Baking only uses the CPU, the texture is created separately with CreateTexture.*/
+class BakedAnimation
+{
+public:
+	static const int TEXTURE_WIDTH = 1024;
+
+	/*Sample animation frameRate times per second. Frames are spread evenly over the clip, so the rate is
+	rounded to loop seamlessly. model is only needed to bake vertex positions.*/
+	static BakedAnimation Bake(Animation& animation, BakeMode mode, float frameRate, const Model* model = nullptr)
+	{
+		BakedAnimation baked;
+		baked.m_Mode = mode;
+		baked.m_FrameCount = GetFrameCount(animation, frameRate);
+		baked.m_FrameRate = baked.m_FrameCount * animation.GetTicksPerSecond() / animation.GetDuration();
+		baked.m_ElementCount = mode == BakeMode::BoneMatrices ? animation.GetBoneCount() : CountVertices(*model);
+		baked.m_TexelsPerFrame = mode == BakeMode::BoneMatrices ? baked.m_ElementCount * 4 : baked.m_ElementCount;
+		baked.SetSource(animation, mode == BakeMode::VertexPositions ? model : nullptr);
+		baked.m_Texels.resize(static_cast<std::size_t>(baked.m_FrameCount) * baked.m_TexelsPerFrame);
+
+		std::vector<BoneCursor> cursors(animation.GetBones().size());
+		std::vector<glm::mat4> globalTransforms(animation.GetSkeleton().size());
+		std::vector<glm::mat4> palette(animation.GetBoneCount(), glm::mat4(1.0f));
+		std::unique_ptr<CpuSkinner> skinner;
+		if (mode == BakeMode::VertexPositions)
+			skinner.reset(new CpuSkinner(*model));
+
+		for (int frame = 0; frame < baked.m_FrameCount; frame++)
+		{
+			const float animationTime = animation.GetDuration() * frame / baked.m_FrameCount;
+			animation.Evaluate(animationTime, cursors.data(), globalTransforms.data(), palette.data());
+
+			glm::vec4* texels = &baked.m_Texels[static_cast<std::size_t>(frame) * baked.m_TexelsPerFrame];
+			if (mode == BakeMode::BoneMatrices)
+			{
+				for (int bone = 0; bone < baked.m_ElementCount; bone++)
+					for (int column = 0; column < 4; column++)
+						texels[bone * 4 + column] = palette[bone][column];
+			}
+			else
+			{
+				skinner->Skin(palette.data());
+				for (int vertex = 0; vertex < baked.m_ElementCount; vertex++)
+					texels[vertex] = glm::vec4(skinner->GetPosition(vertex), 1.0f);
+			}
+		}
+		return baked;
+	}
+
+	/*Load the bake cached at cachePath if it was made from the same animation with the same settings,
+	otherwise bake it and save it there*/
+	static BakedAnimation LoadOrBake(const std::string& cachePath, Animation& animation, BakeMode mode, float frameRate, const Model* model = nullptr)
+	{
+		BakedAnimation baked;
+		if (baked.Load(cachePath) && baked.m_Mode == mode && baked.m_FrameCount == GetFrameCount(animation, frameRate) &&
+			baked.IsBakedFrom(animation, mode == BakeMode::VertexPositions ? model : nullptr) &&
+			baked.m_ElementCount == (mode == BakeMode::BoneMatrices ? animation.GetBoneCount() : CountVertices(*model)))
+			return baked;
+
+		baked = Bake(animation, mode, frameRate, model);
+		if (!baked.Save(cachePath))
+			std::cout << "ERROR::BAKED_ANIMATION::FAILED_TO_WRITE " << cachePath << std::endl;
+		return baked;
+	}
+
+	bool Save(const std::string& path) const
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		const Header header = { FILE_MAGIC, FILE_VERSION, m_Mode, m_FrameCount, m_ElementCount, m_TexelsPerFrame, m_FrameRate, m_SourceDuration, m_SourceTicksPerSecond, m_SourceChannelCount, m_SourceKey };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(m_Texels.data()), m_Texels.size() * sizeof(glm::vec4));
+		return static_cast<bool>(file);
+	}
+
+	bool Load(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		Header header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+			return false;
+
+		if (header.frameCount <= 0 || header.elementCount <= 0 || header.texelsPerFrame <= 0)
+			return false;
+		// the texels fill the rest of the file: check the counts against its size, so a truncated or corrupt cache is
+		// rebaked instead of making us allocate whatever it claims
+		const std::streampos texelsStart = file.tellg();
+		file.seekg(0, std::ios::end);
+		const std::streamoff remaining = file.tellg() - texelsStart;
+		file.seekg(texelsStart);
+		const std::uint64_t texelCount = static_cast<std::uint64_t>(header.frameCount) * static_cast<std::uint64_t>(header.texelsPerFrame);
+		if (remaining % sizeof(glm::vec4) != 0 || texelCount != static_cast<std::uint64_t>(remaining) / sizeof(glm::vec4))
+			return false;
+
+		std::vector<glm::vec4> texels(static_cast<std::size_t>(texelCount));
+		if (!file.read(reinterpret_cast<char*>(texels.data()), texels.size() * sizeof(glm::vec4)))
+			return false;
+
+		m_Mode = header.mode;
+		m_FrameCount = header.frameCount;
+		m_ElementCount = header.elementCount;
+		m_TexelsPerFrame = header.texelsPerFrame;
+		m_FrameRate = header.frameRate;
+		m_SourceDuration = header.sourceDuration;
+		m_SourceTicksPerSecond = header.sourceTicksPerSecond;
+		m_SourceChannelCount = header.sourceChannelCount;
+		m_SourceKey = header.sourceKey;
+		m_Texels.swap(texels);
+		return true;
+	}
+
+	/*RGBA32F texture of TEXTURE_WIDTH texels per row, sampled with texelFetch (no filtering)*/
+	unsigned int CreateTexture() const
+	{
+		const int height = static_cast<int>((m_Texels.size() + TEXTURE_WIDTH - 1) / TEXTURE_WIDTH);
+		std::vector<glm::vec4> rows(m_Texels);
+		rows.resize(static_cast<std::size_t>(height) * TEXTURE_WIDTH, glm::vec4(0.0f));
+
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, TEXTURE_WIDTH, height, 0, GL_RGBA, GL_FLOAT, rows.data());
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+
+	glm::mat4 GetBoneMatrix(int frame, int bone) const
+	{
+		const glm::vec4* texels = &m_Texels[static_cast<std::size_t>(frame) * m_TexelsPerFrame + bone * 4];
+		return glm::mat4(texels[0], texels[1], texels[2], texels[3]);
+	}
+
+	glm::vec3 GetVertexPosition(int frame, int vertex) const
+	{
+		return glm::vec3(m_Texels[static_cast<std::size_t>(frame) * m_TexelsPerFrame + vertex]);
+	}
+
+	BakeMode GetMode() const { return m_Mode; }
+	int GetFrameCount() const { return m_FrameCount; }
+	float GetFrameRate() const { return m_FrameRate; }
+	int GetTexelsPerFrame() const { return m_TexelsPerFrame; }
+	std::size_t GetSize() const { return m_Texels.size() * sizeof(glm::vec4); }
+
+private:
+	static const std::uint32_t FILE_MAGIC = 0x31544156; // "VAT1"
+	static const std::uint32_t FILE_VERSION = 2;
+
+	struct Header
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		BakeMode mode;
+		std::int32_t frameCount;
+		std::int32_t elementCount;
+		std::int32_t texelsPerFrame;
+		float frameRate;
+		float sourceDuration;
+		float sourceTicksPerSecond;
+		std::int32_t sourceChannelCount;
+		std::uint64_t sourceKey;
+	};
+
+	static int GetFrameCount(Animation& animation, float frameRate)
+	{
+		const float seconds = animation.GetDuration() / animation.GetTicksPerSecond();
+		return std::max(1, static_cast<int>(std::round(seconds * frameRate)));
+	}
+
+	static int CountVertices(const Model& model)
+	{
+		std::size_t vertexCount = 0;
+		for (const Mesh& mesh : model.meshes)
+			vertexCount += mesh.vertices.size();
+		return static_cast<int>(vertexCount);
+	}
+
+	/*FNV-1a of everything the bake is sampled from: the skeleton, the keys (or their compressed copy) and, for
+	vertex positions, the skinned vertices. Editing any key of the source changes the key.*/
+	static std::uint64_t ComputeSourceKey(Animation& animation, const Model* model)
+	{
+		std::uint64_t key = 14695981039346656037ull;
+		auto hash = [&key](const void* data, std::size_t size)
+		{
+			for (std::size_t i = 0; i < size; i++)
+				key = (key ^ static_cast<const unsigned char*>(data)[i]) * 1099511628211ull;
+		};
+
+		for (const SkeletonNode& node : animation.GetSkeleton())
+		{
+			hash(&node.transformation, sizeof(node.transformation));
+			hash(&node.offset, sizeof(node.offset));
+			const std::int32_t indices[3] = { node.parentIndex, node.channelIndex, node.boneIndex };
+			hash(indices, sizeof(indices));
+		}
+		for (const Bone& bone : animation.GetBones())
+		{
+			hash(bone.GetPositionKeys().data(), bone.GetPositionKeys().size() * sizeof(KeyPosition));
+			hash(bone.GetRotationKeys().data(), bone.GetRotationKeys().size() * sizeof(KeyRotation));
+			hash(bone.GetScaleKeys().data(), bone.GetScaleKeys().size() * sizeof(KeyScale));
+		}
+		const std::vector<std::uint16_t>& compressedData = animation.GetCompressedClip().GetData();
+		hash(compressedData.data(), compressedData.size() * sizeof(std::uint16_t));
+
+		if (model)
+		{
+			for (const Mesh& mesh : model->meshes)
+			{
+				for (const Vertex& vertex : mesh.vertices)
+				{
+					hash(&vertex.Position, sizeof(vertex.Position));
+					hash(vertex.m_BoneIDs, sizeof(vertex.m_BoneIDs));
+					hash(vertex.m_Weights, sizeof(vertex.m_Weights));
+				}
+			}
+		}
+		return key;
+	}
+
+	void SetSource(Animation& animation, const Model* model)
+	{
+		m_SourceDuration = animation.GetDuration();
+		m_SourceTicksPerSecond = animation.GetTicksPerSecond();
+		m_SourceChannelCount = static_cast<int>(animation.GetBones().size());
+		m_SourceKey = ComputeSourceKey(animation, model);
+	}
+
+	bool IsBakedFrom(Animation& animation, const Model* model) const
+	{
+		return m_SourceDuration == animation.GetDuration() && m_SourceTicksPerSecond == animation.GetTicksPerSecond() &&
+			m_SourceChannelCount == static_cast<int>(animation.GetBones().size()) && m_SourceKey == ComputeSourceKey(animation, model);
+	}
+
+	BakeMode m_Mode = BakeMode::BoneMatrices;
+	int m_FrameCount = 0;
+	int m_ElementCount = 0;
+	int m_TexelsPerFrame = 0;
+	float m_FrameRate = 0.0f;
+	float m_SourceDuration = 0.0f;
+	float m_SourceTicksPerSecond = 0.0f;
+	int m_SourceChannelCount = 0;
+	std::uint64_t m_SourceKey = 0;
+	std::vector<glm::vec4> m_Texels;
+};
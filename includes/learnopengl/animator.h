@@ -1,80 +1,324 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <vector>
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
 #include <learnopengl/animation.h>
 #include <learnopengl/bone.h>
+#include <glm/gtx/dual_quaternion.hpp>
 
+/*Plays any number of weighted clips on the skeleton of its first animation.
+Regular clips are blended by weight in local space (a crossfade animates their weights), a mask restricts a clip
+to part of the skeleton, and additive clips add their difference to their first frame on top of the blend.
+Clips are bound to the skeleton when they are added, so updating doesn't allocate.*/
 class Animator
 {
 public:
 	Animator(Animation* animation)
 	{
-		m_CurrentTime = 0.0;
 		m_CurrentAnimation = animation;
 
 		m_FinalBoneMatrices.reserve(100);
 
 		for (int i = 0; i < 100; i++)
 			m_FinalBoneMatrices.push_back(glm::mat4(1.0f));
+
+		if (animation)
+			AddClip(animation, 1.0f);
 	}
 
 	void UpdateAnimation(float dt)
 	{
 		m_DeltaTime = dt;
-		if (m_CurrentAnimation)
+		if (!m_CurrentAnimation)
+			return;
+
+		for (AnimationClip& clip : m_Clips)
+		{
+			if (clip.weight != clip.targetWeight)
+			{
+				const float step = clip.fadeSpeed * dt;
+				if (std::abs(clip.targetWeight - clip.weight) <= step)
+					clip.weight = clip.targetWeight;
+				else
+					clip.weight += clip.weight < clip.targetWeight ? step : -step;
+			}
+
+			if (clip.weight > 0.0f)
+			{
+				clip.time += clip.animation->GetTicksPerSecond() * clip.speed * dt;
+				clip.time = fmod(clip.time, clip.animation->GetDuration());
+				if (clip.time < 0.0f) //fmod keeps the sign of a clip played backwards
+					clip.time += clip.animation->GetDuration();
+			}
+		}
+		CalculateBoneTransforms();
+
+		if (m_DualQuaternionOutput)
 		{
-			m_CurrentTime += m_CurrentAnimation->GetTicksPerSecond() * dt;
-			m_CurrentTime = fmod(m_CurrentTime, m_CurrentAnimation->GetDuration());
-			CalculateBoneTransform(&m_CurrentAnimation->GetRootNode(), glm::mat4(1.0f));
+			m_DualQuaternions.resize(m_FinalBoneMatrices.size());
+			for (size_t i = 0; i < m_FinalBoneMatrices.size(); i++)
+				m_DualQuaternions[i] = ToDualQuaternion(m_FinalBoneMatrices[i]);
 		}
 	}
 
+	/*Stop every clip and play pAnimation alone from its start*/
 	void PlayAnimation(Animation* pAnimation)
 	{
 		m_CurrentAnimation = pAnimation;
-		m_CurrentTime = 0.0f;
+		m_Clips.clear();
+		if (pAnimation)
+			AddClip(pAnimation, 1.0f);
 	}
 
-	void CalculateBoneTransform(const AssimpNodeData* node, glm::mat4 parentTransform)
+	/*Bind a clip to the skeleton and return its index. additive clips are applied relative to their first frame.
+	The first clip added to an animator created without an animation provides the skeleton.*/
+	int AddClip(Animation* animation, float weight = 0.0f, bool additive = false)
 	{
-		std::string nodeName = node->name;
-		glm::mat4 nodeTransform = node->transformation;
+		if (!m_CurrentAnimation)
+			m_CurrentAnimation = animation;
 
-		Bone* Bone = m_CurrentAnimation->FindBone(nodeName);
+		AnimationClip clip;
+		clip.animation = animation;
+		clip.weight = weight;
+		clip.targetWeight = weight;
+		clip.additive = additive;
+		clip.cursors.resize(animation->GetBones().size());
 
-		if (Bone)
+		const std::vector<SkeletonNode>& skeleton = m_CurrentAnimation->GetSkeleton();
+		clip.nodeChannels.resize(skeleton.size());
+		for (size_t i = 0; i < skeleton.size(); i++)
+			clip.nodeChannels[i] = animation == m_CurrentAnimation ? skeleton[i].channelIndex : animation->FindChannelIndex(m_CurrentAnimation->GetNodeName(static_cast<int>(i)));
+
+		if (additive)
 		{
-			Bone->Update(m_CurrentTime);
-			nodeTransform = Bone->GetLocalTransform();
+			clip.referencePose.resize(animation->GetBones().size());
+			for (size_t channel = 0; channel < clip.referencePose.size(); channel++)
+			{
+				BoneCursor cursor;
+				clip.referencePose[channel] = animation->SamplePose(static_cast<int>(channel), 0.0f, cursor);
+			}
 		}
 
-		glm::mat4 globalTransformation = parentTransform * nodeTransform;
+		m_Clips.push_back(clip);
+		GrowFinalBoneMatrices(*animation);
+		m_GlobalTransforms.resize(std::max(m_GlobalTransforms.size(), animation->GetSkeleton().size()));
+		m_Poses.resize(skeleton.size());
+		m_PoseWeights.resize(skeleton.size());
+		return static_cast<int>(m_Clips.size()) - 1;
+	}
+
+	void SetClipWeight(int clip, float weight)
+	{
+		m_Clips[clip].weight = weight;
+		m_Clips[clip].targetWeight = weight;
+	}
+
+	void SetClipSpeed(int clip, float speed) { m_Clips[clip].speed = speed; }
+	void SetClipTime(int clip, float time) { m_Clips[clip].time = time; }
 
-		auto boneInfoMap = m_CurrentAnimation->GetBoneIDMap();
-		if (boneInfoMap.find(nodeName) != boneInfoMap.end())
+	/*Per skeleton node weights (see Animation::CreateBoneMask), an empty mask applies the clip to the whole skeleton*/
+	void SetClipMask(int clip, const std::vector<float>& mask) { m_Clips[clip].mask = mask; }
+
+	/*Fade the regular clip in to full weight and every other regular clip out, over duration seconds*/
+	void CrossFade(int clip, float duration)
+	{
+		for (size_t i = 0; i < m_Clips.size(); i++)
 		{
-			int index = boneInfoMap[nodeName].id;
-			glm::mat4 offset = boneInfoMap[nodeName].offset;
-			m_FinalBoneMatrices[index] = globalTransformation * offset;
+			AnimationClip& other = m_Clips[i];
+			if (other.additive)
+				continue;
+
+			other.targetWeight = static_cast<int>(i) == clip ? 1.0f : 0.0f;
+			if (duration > 0.0f)
+				other.fadeSpeed = 1.0f / duration;
+			else
+				other.weight = other.targetWeight;
 		}
+	}
 
-		for (int i = 0; i < node->childrenCount; i++)
-			CalculateBoneTransform(&node->children[i], globalTransformation);
+	float GetClipWeight(int clip) const { return m_Clips[clip].weight; }
+
+	/*The skeleton is sorted parents first, so a single pass computes every global transform*/
+	void CalculateBoneTransforms()
+	{
+		//a single unmasked clip of the skeleton's own animation needs no blending, sample it straight into the palette.
+		//other animations may order or miss nodes differently, they go through the node channel mapping of the blend
+		AnimationClip* singleClip = nullptr;
+		int activeClips = 0;
+		for (AnimationClip& clip : m_Clips)
+		{
+			if (clip.weight > 0.0f)
+			{
+				singleClip = &clip;
+				activeClips++;
+			}
+		}
+
+		if (activeClips == 0)
+			return;
+
+		if (activeClips == 1 && singleClip->animation == m_CurrentAnimation && !singleClip->additive && singleClip->mask.empty())
+		{
+			singleClip->animation->Evaluate(singleClip->time, singleClip->cursors.data(), m_GlobalTransforms.data(), m_FinalBoneMatrices.data());
+			return;
+		}
+
+		BlendClips();
+
+		const std::vector<SkeletonNode>& skeleton = m_CurrentAnimation->GetSkeleton();
+		for (size_t i = 0; i < skeleton.size(); i++)
+		{
+			const SkeletonNode& node = skeleton[i];
+			const glm::mat4 nodeTransform = m_PoseWeights[i] > 0.0f ? m_Poses[i].ToMatrix() : node.transformation;
+
+			if (node.parentIndex >= 0)
+				m_GlobalTransforms[i] = m_GlobalTransforms[node.parentIndex] * nodeTransform;
+			else
+				m_GlobalTransforms[i] = nodeTransform;
+
+			if (node.boneIndex >= 0)
+				m_FinalBoneMatrices[node.boneIndex] = m_GlobalTransforms[i] * node.offset;
+		}
 	}
 
-	std::vector<glm::mat4> GetFinalBoneMatrices()
+	const std::vector<glm::mat4>& GetFinalBoneMatrices() const
 	{
 		return m_FinalBoneMatrices;
 	}
 
+	/*Also output the palette as dual quaternions on every update, for dual quaternion skinning*/
+	void SetDualQuaternionOutput(bool enabled) { m_DualQuaternionOutput = enabled; }
+
+	/*The final bone matrices as dual quaternions: 8 floats per bone instead of 16*/
+	const std::vector<glm::dualquat>& GetDualQuaternions() const
+	{
+		return m_DualQuaternions;
+	}
+
+	/*Rotation and translation of a bone matrix, any scale is dropped since a dual quaternion can't hold it*/
+	static glm::dualquat ToDualQuaternion(const glm::mat4& transform)
+	{
+		const glm::mat3 rotation(glm::normalize(glm::vec3(transform[0])), glm::normalize(glm::vec3(transform[1])), glm::normalize(glm::vec3(transform[2])));
+		return glm::dualquat(glm::normalize(glm::quat_cast(rotation)), glm::vec3(transform[3]));
+	}
+
 private:
+	struct AnimationClip
+	{
+		Animation* animation = nullptr;
+		float time = 0.0f;
+		float speed = 1.0f;
+		float weight = 0.0f;
+		float targetWeight = 0.0f;
+		float fadeSpeed = 0.0f;
+		bool additive = false;
+
+		/*channel of the clip animating each skeleton node, -1 if it doesn't*/
+		std::vector<int> nodeChannels;
+		std::vector<BoneCursor> cursors;
+		std::vector<float> mask;
+
+		/*first frame of an additive clip, per channel*/
+		std::vector<BonePose> referencePose;
+	};
+
+	/*Accumulate the local pose of every node: weighted average of the regular clips, then the additive clips on top*/
+	void BlendClips()
+	{
+		const std::vector<SkeletonNode>& skeleton = m_CurrentAnimation->GetSkeleton();
+		std::fill(m_PoseWeights.begin(), m_PoseWeights.end(), 0.0f);
+
+		for (AnimationClip& clip : m_Clips)
+		{
+			if (clip.weight <= 0.0f || clip.additive)
+				continue;
+
+			for (size_t i = 0; i < skeleton.size(); i++)
+			{
+				const float weight = clip.mask.empty() ? clip.weight : clip.weight * clip.mask[i];
+				if (weight <= 0.0f)
+					continue;
+
+				const int channel = clip.nodeChannels[i];
+				const BonePose pose = channel >= 0 ? clip.animation->SamplePose(channel, clip.time, clip.cursors[channel]) : skeleton[i].bindPose;
+
+				BonePose& blended = m_Poses[i];
+				if (m_PoseWeights[i] == 0.0f)
+				{
+					blended.position = pose.position * weight;
+					blended.rotation = pose.rotation * weight;
+					blended.scale = pose.scale * weight;
+				}
+				else
+				{
+					blended.position += pose.position * weight;
+					//q and -q are the same rotation, keep the accumulated quaternions in the same hemisphere
+					blended.rotation += glm::dot(blended.rotation, pose.rotation) < 0.0f ? pose.rotation * -weight : pose.rotation * weight;
+					blended.scale += pose.scale * weight;
+				}
+				m_PoseWeights[i] += weight;
+			}
+		}
+
+		for (size_t i = 0; i < skeleton.size(); i++)
+		{
+			if (m_PoseWeights[i] > 0.0f)
+			{
+				BonePose& blended = m_Poses[i];
+				blended.position /= m_PoseWeights[i];
+				blended.rotation = glm::normalize(blended.rotation);
+				blended.scale /= m_PoseWeights[i];
+			}
+		}
+
+		for (AnimationClip& clip : m_Clips)
+		{
+			if (clip.weight <= 0.0f || !clip.additive)
+				continue;
+
+			for (size_t i = 0; i < skeleton.size(); i++)
+			{
+				const int channel = clip.nodeChannels[i];
+				const float weight = clip.mask.empty() ? clip.weight : clip.weight * clip.mask[i];
+				if (channel < 0 || weight <= 0.0f)
+					continue;
+
+				BonePose& blended = m_Poses[i];
+				if (m_PoseWeights[i] == 0.0f)
+				{
+					blended = skeleton[i].bindPose;
+					m_PoseWeights[i] = 1.0f;
+				}
+
+				const BonePose pose = clip.animation->SamplePose(channel, clip.time, clip.cursors[channel]);
+				const BonePose& reference = clip.referencePose[channel];
+				const glm::quat deltaRotation = glm::inverse(reference.rotation) * pose.rotation;
+				blended.position += (pose.position - reference.position) * weight;
+				blended.rotation = glm::normalize(blended.rotation * glm::slerp(glm::quat(1.0f, 0.0f, 0.0f, 0.0f), deltaRotation, weight));
+				blended.scale *= glm::mix(glm::vec3(1.0f), pose.scale / reference.scale, weight);
+			}
+		}
+	}
+
+	void GrowFinalBoneMatrices(Animation& animation)
+	{
+		if (animation.GetBoneCount() > static_cast<int>(m_FinalBoneMatrices.size()))
+			m_FinalBoneMatrices.resize(animation.GetBoneCount(), glm::mat4(1.0f));
+	}
+
 	std::vector<glm::mat4> m_FinalBoneMatrices;
+	std::vector<glm::mat4> m_GlobalTransforms;
+	std::vector<AnimationClip> m_Clips;
+	std::vector<BonePose> m_Poses;
+	std::vector<float> m_PoseWeights;
+	std::vector<glm::dualquat> m_DualQuaternions;
+	bool m_DualQuaternionOutput = false;
 	Animation* m_CurrentAnimation;
-	float m_CurrentTime;
 	float m_DeltaTime;
 
 };
@@ -3,6 +3,7 @@
 /* Container for bone data */
 
 #include <vector>
+#include <algorithm>
 #include <assimp/scene.h>
 #include <list>
 #include <glm/glm.hpp>
@@ -28,6 +29,28 @@ struct KeyScale
 	float timeStamp;
 };
 
+/*Local transform of a bone split in translation, rotation and scale, the space in which poses are blended*/
+struct BonePose
+{
+	glm::vec3 position;
+	glm::quat rotation;
+	glm::vec3 scale;
+
+	glm::mat4 ToMatrix() const
+	{
+		return glm::translate(glm::mat4(1.0f), position) * glm::toMat4(rotation) * glm::scale(glm::mat4(1.0f), scale);
+	}
+};
+
+/*Keyframe indices of the last sample, one per instance playing the animation.
+Forward playback usually lands in the same or the next key interval.*/
+struct BoneCursor
+{
+	int position = 0;
+	int rotation = 0;
+	int scale = 0;
+};
+
 class Bone
 {
 public:
@@ -74,104 +97,149 @@ public:
 	
 	void Update(float animationTime)
 	{
-		glm::mat4 translation = InterpolatePosition(animationTime);
-		glm::mat4 rotation = InterpolateRotation(animationTime);
-		glm::mat4 scale = InterpolateScaling(animationTime);
-		m_LocalTransform = translation * rotation * scale;
+		m_LocalTransform = Sample(animationTime, m_Cursor);
+	}
+
+	/*Local transform at animationTime. Doesn't modify the bone, so instances sharing the animation only need their own cursor.*/
+	glm::mat4 Sample(float animationTime, BoneCursor& cursor) const
+	{
+		return SamplePose(animationTime, cursor).ToMatrix();
+	}
+
+	BonePose SamplePose(float animationTime, BoneCursor& cursor) const
+	{
+		BonePose pose;
+		pose.position = InterpolatePosition(animationTime, cursor.position);
+		pose.rotation = InterpolateRotation(animationTime, cursor.rotation);
+		pose.scale = InterpolateScaling(animationTime, cursor.scale);
+		return pose;
 	}
 	glm::mat4 GetLocalTransform() { return m_LocalTransform; }
+	const std::vector<KeyPosition>& GetPositionKeys() const { return m_Positions; }
+	const std::vector<KeyRotation>& GetRotationKeys() const { return m_Rotations; }
+	const std::vector<KeyScale>& GetScaleKeys() const { return m_Scales; }
+
+	/*Size of the keys in memory*/
+	size_t GetKeySize() const
+	{
+		return m_Positions.size() * sizeof(KeyPosition) + m_Rotations.size() * sizeof(KeyRotation) + m_Scales.size() * sizeof(KeyScale);
+	}
+
+	/*Free the keys once the animation samples a compressed copy of them. Sample and Update can't be used afterwards.*/
+	void ReleaseKeys()
+	{
+		std::vector<KeyPosition>().swap(m_Positions);
+		std::vector<KeyRotation>().swap(m_Rotations);
+		std::vector<KeyScale>().swap(m_Scales);
+		m_NumPositions = m_NumRotations = m_NumScalings = 0;
+	}
 	std::string GetBoneName() const { return m_Name; }
 	int GetBoneID() { return m_ID; }
 	
 
 
-	int GetPositionIndex(float animationTime)
+	/*Index of the key starting the interval containing animationTime, clamped to the first and last intervals*/
+	int GetPositionIndex(float animationTime) const
 	{
-		for (int index = 0; index < m_NumPositions - 1; ++index)
-		{
-			if (animationTime < m_Positions[index + 1].timeStamp)
-				return index;
-		}
-		assert(0);
+		int cursor = 0;
+		return FindKeyIndex(m_Positions, animationTime, cursor);
 	}
 
-	int GetRotationIndex(float animationTime)
+	int GetRotationIndex(float animationTime) const
 	{
-		for (int index = 0; index < m_NumRotations - 1; ++index)
-		{
-			if (animationTime < m_Rotations[index + 1].timeStamp)
-				return index;
-		}
-		assert(0);
+		int cursor = 0;
+		return FindKeyIndex(m_Rotations, animationTime, cursor);
 	}
 
-	int GetScaleIndex(float animationTime)
+	int GetScaleIndex(float animationTime) const
 	{
-		for (int index = 0; index < m_NumScalings - 1; ++index)
-		{
-			if (animationTime < m_Scales[index + 1].timeStamp)
-				return index;
-		}
-		assert(0);
+		int cursor = 0;
+		return FindKeyIndex(m_Scales, animationTime, cursor);
 	}
 
 
 private:
 
-	float GetScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime)
+	/*Checks the cursor's interval and the next one first, then falls back to a binary search (seeks, loops)*/
+	template<typename TKey>
+	static int FindKeyIndex(const std::vector<TKey>& keys, float animationTime, int& cursor)
+	{
+		const int lastIndex = static_cast<int>(keys.size()) - 2;
+		if (lastIndex < 0 || animationTime <= keys[0].timeStamp)
+			return cursor = 0;
+		if (animationTime >= keys[lastIndex + 1].timeStamp)
+			return cursor = lastIndex;
+
+		int index = std::min(cursor, lastIndex);
+		if (animationTime >= keys[index].timeStamp)
+		{
+			if (animationTime < keys[index + 1].timeStamp)
+				return cursor = index;
+			if (index + 1 <= lastIndex && animationTime < keys[index + 2].timeStamp)
+				return cursor = index + 1;
+		}
+
+		auto next = std::upper_bound(keys.begin(), keys.end(), animationTime,
+			[](float time, const TKey& key) { return time < key.timeStamp; });
+		return cursor = static_cast<int>(next - keys.begin()) - 1;
+	}
+
+	static float GetScaleFactor(float lastTimeStamp, float nextTimeStamp, float animationTime)
 	{
-		float scaleFactor = 0.0f;
 		float midWayLength = animationTime - lastTimeStamp;
 		float framesDiff = nextTimeStamp - lastTimeStamp;
-		scaleFactor = midWayLength / framesDiff;
-		return scaleFactor;
+		if (framesDiff <= 0.0f)
+			return 0.0f;
+		return glm::clamp(midWayLength / framesDiff, 0.0f, 1.0f);
 	}
 
-	glm::mat4 InterpolatePosition(float animationTime)
+	glm::vec3 InterpolatePosition(float animationTime, int& cursor) const
 	{
+		if (0 == m_NumPositions) //a channel may leave some of its tracks empty, they keep the identity
+			return glm::vec3(0.0f);
 		if (1 == m_NumPositions)
-			return glm::translate(glm::mat4(1.0f), m_Positions[0].position);
+			return m_Positions[0].position;
 
-		int p0Index = GetPositionIndex(animationTime);
+		int p0Index = FindKeyIndex(m_Positions, animationTime, cursor);
 		int p1Index = p0Index + 1;
 		float scaleFactor = GetScaleFactor(m_Positions[p0Index].timeStamp,
 			m_Positions[p1Index].timeStamp, animationTime);
 		glm::vec3 finalPosition = glm::mix(m_Positions[p0Index].position, m_Positions[p1Index].position
 			, scaleFactor);
-		return glm::translate(glm::mat4(1.0f), finalPosition);
+		return finalPosition;
 	}
 
-	glm::mat4 InterpolateRotation(float animationTime)
+	glm::quat InterpolateRotation(float animationTime, int& cursor) const
 	{
+		if (0 == m_NumRotations)
+			return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
 		if (1 == m_NumRotations)
-		{
-			auto rotation = glm::normalize(m_Rotations[0].orientation);
-			return glm::toMat4(rotation);
-		}
+			return glm::normalize(m_Rotations[0].orientation);
 
-		int p0Index = GetRotationIndex(animationTime);
+		int p0Index = FindKeyIndex(m_Rotations, animationTime, cursor);
 		int p1Index = p0Index + 1;
 		float scaleFactor = GetScaleFactor(m_Rotations[p0Index].timeStamp,
 			m_Rotations[p1Index].timeStamp, animationTime);
 		glm::quat finalRotation = glm::slerp(m_Rotations[p0Index].orientation, m_Rotations[p1Index].orientation
 			, scaleFactor);
-		finalRotation = glm::normalize(finalRotation);
-		return glm::toMat4(finalRotation);
+		return glm::normalize(finalRotation);
 
 	}
 
-	glm::mat4 InterpolateScaling(float animationTime)
+	glm::vec3 InterpolateScaling(float animationTime, int& cursor) const
 	{
+		if (0 == m_NumScalings)
+			return glm::vec3(1.0f);
 		if (1 == m_NumScalings)
-			return glm::scale(glm::mat4(1.0f), m_Scales[0].scale);
+			return m_Scales[0].scale;
 
-		int p0Index = GetScaleIndex(animationTime);
+		int p0Index = FindKeyIndex(m_Scales, animationTime, cursor);
 		int p1Index = p0Index + 1;
 		float scaleFactor = GetScaleFactor(m_Scales[p0Index].timeStamp,
 			m_Scales[p1Index].timeStamp, animationTime);
 		glm::vec3 finalScale = glm::mix(m_Scales[p0Index].scale, m_Scales[p1Index].scale
 			, scaleFactor);
-		return glm::scale(glm::mat4(1.0f), finalScale);
+		return finalScale;
 	}
 
 	std::vector<KeyPosition> m_Positions;
@@ -182,6 +250,7 @@ private:
 	int m_NumScalings;
 
 	glm::mat4 m_LocalTransform;
+	BoneCursor m_Cursor;
 	std::string m_Name;
 	int m_ID;
 };
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#define GLM_ENABLE_EXPERIMENTAL
+#endif
+#include <glm/gtx/dual_quaternion.hpp>
+#include <cstddef>
+
+/*Bone matrices stored in a texture buffer (GL 3.3 has no SSBO), so a whole palette - or the palettes of a whole
+crowd - is uploaded with one buffer update instead of one uniform call per bone.
+Every matrix takes 4 RGBA32F texels, one per column. The skinning shader reads bone b of the palette starting at
+paletteOffset with:
+	texelFetch(bonePalette, (paletteOffset + b) * 4 + column)
+A dual quaternion palette takes half the space, 2 texels per bone.*/
+class BonePaletteBuffer
+{
+public:
+	BonePaletteBuffer()
+	{
+		glGenBuffers(1, &m_Buffer);
+		glGenTextures(1, &m_Texture);
+	}
+
+	~BonePaletteBuffer()
+	{
+		glDeleteTextures(1, &m_Texture);
+		glDeleteBuffers(1, &m_Buffer);
+	}
+
+	BonePaletteBuffer(const BonePaletteBuffer&) = delete;
+	BonePaletteBuffer& operator=(const BonePaletteBuffer&) = delete;
+
+	void Upload(const glm::mat4* matrices, std::size_t count)
+	{
+		UploadTexels(matrices, count * sizeof(glm::mat4));
+	}
+
+	/*Dual quaternion palette, 2 texels per bone: the real part then the dual part, both stored x, y, z, w*/
+	void Upload(const glm::dualquat* dualQuaternions, std::size_t count)
+	{
+		UploadTexels(dualQuaternions, count * sizeof(glm::dualquat));
+	}
+
+	/*Bind the palette to the texture unit sampled by the bonePalette uniform*/
+	void Bind(unsigned int textureUnit) const
+	{
+		glActiveTexture(GL_TEXTURE0 + textureUnit);
+		glBindTexture(GL_TEXTURE_BUFFER, m_Texture);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+private:
+	void UploadTexels(const void* data, std::size_t size)
+	{
+		glBindBuffer(GL_TEXTURE_BUFFER, m_Buffer);
+		if (size > m_Capacity)
+		{
+			glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+			m_Capacity = size;
+
+			glBindTexture(GL_TEXTURE_BUFFER, m_Texture);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_Buffer);
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+		}
+		else
+		{
+			//orphan the storage so the driver doesn't wait for the draws still reading last frame's palettes
+			glBufferData(GL_TEXTURE_BUFFER, m_Capacity, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+		}
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+
+	unsigned int m_Buffer = 0;
+	unsigned int m_Texture = 0;
+	/*in bytes*/
+	std::size_t m_Capacity = 0;
+};
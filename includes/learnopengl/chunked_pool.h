@@ -0,0 +1,144 @@
+#ifndef CHUNKED_POOL_H
+#define CHUNKED_POOL_H
+
+#include <cstddef> //std::size_t
+#include <cstdint> //std::uint32_t
+#include <memory> //std::unique_ptr
+#include <new> //placement new
+#include <type_traits> //std::aligned_storage_t
+#include <utility> //std::forward
+#include <vector> //std::vector
+
+//Handle to an object living in a ChunkedPool. The generation detects handles to a slot that was released and reused.
+struct PoolHandle
+{
+	std::uint32_t index = ~0u;
+	std::uint32_t generation = 0;
+
+	bool isValid() const
+	{
+		return index != ~0u;
+	}
+
+	bool operator==(const PoolHandle& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator!=(const PoolHandle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+//Allocates objects of type T in fixed size chunks. Chunks are never moved nor freed while the pool lives,
+//so pointers to allocated objects are stable. Released slots are recycled through a free list.
+template<typename T, std::size_t ChunkSize = 256>
+class ChunkedPool
+{
+public:
+	ChunkedPool() = default;
+	ChunkedPool(const ChunkedPool&) = delete;
+	ChunkedPool& operator=(const ChunkedPool&) = delete;
+
+	~ChunkedPool()
+	{
+		for (std::uint32_t i = 0; i < m_slotCount; ++i)
+		{
+			Slot& slot = getSlot(i);
+			if (slot.alive)
+			{
+				slot.alive = false;
+				reinterpret_cast<T*>(&slot.storage)->~T();
+			}
+		}
+	}
+
+	//Construct a new object in the pool. Argument input is forwarded to the constructor of T.
+	template<typename... TArgs>
+	PoolHandle create(TArgs&&... args)
+	{
+		std::uint32_t index;
+		if (m_freeHead != ~0u)
+		{
+			index = m_freeHead;
+			m_freeHead = getSlot(index).nextFree;
+		}
+		else
+		{
+			if (m_slotCount == m_chunks.size() * ChunkSize)
+			{
+				m_chunks.emplace_back(new Slot[ChunkSize]);
+				++m_chunkAllocations;
+			}
+			index = m_slotCount++;
+		}
+
+		Slot& slot = getSlot(index);
+		new (&slot.storage) T(std::forward<TArgs>(args)...);
+		slot.alive = true;
+		++m_liveCount;
+		++m_createCount;
+		return { index, slot.generation };
+	}
+
+	//Destroy the object and give its slot back to the pool. Stale handles are ignored.
+	void destroy(PoolHandle handle)
+	{
+		T* object = get(handle);
+		if (!object)
+			return;
+
+		Slot& slot = getSlot(handle.index);
+		//Mark the slot dead before running the destructor so that a recursive destroy of the same handle is a no-op
+		slot.alive = false;
+		++slot.generation;
+		object->~T();
+		slot.nextFree = m_freeHead;
+		m_freeHead = handle.index;
+		--m_liveCount;
+	}
+
+	//Returns nullptr if the handle does not reference a live object anymore
+	T* get(PoolHandle handle)
+	{
+		if (handle.index >= m_slotCount)
+			return nullptr;
+
+		Slot& slot = getSlot(handle.index);
+		if (!slot.alive || slot.generation != handle.generation)
+			return nullptr;
+		return reinterpret_cast<T*>(&slot.storage);
+	}
+
+	const T* get(PoolHandle handle) const
+	{
+		return const_cast<ChunkedPool*>(this)->get(handle);
+	}
+
+	std::size_t liveCount() const { return m_liveCount; }
+	std::size_t createCount() const { return m_createCount; }
+	std::size_t chunkAllocations() const { return m_chunkAllocations; }
+
+private:
+	struct Slot
+	{
+		std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+		std::uint32_t generation = 0;
+		std::uint32_t nextFree = ~0u;
+		bool alive = false;
+	};
+
+	Slot& getSlot(std::uint32_t index)
+	{
+		return m_chunks[index / ChunkSize][index % ChunkSize];
+	}
+
+	std::vector<std::unique_ptr<Slot[]>> m_chunks;
+	std::uint32_t m_slotCount = 0;
+	std::uint32_t m_freeHead = ~0u;
+	std::size_t m_liveCount = 0;
+	std::size_t m_createCount = 0;
+	std::size_t m_chunkAllocations = 0;
+};
+#endif
@@ -0,0 +1,375 @@
+#pragma once
+
+/* Quantized storage for the keyframes of an animation */
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <learnopengl/bone.h>
+
+/*Result of Animation::Compress: sizes before and after, and the largest error measured on every skeleton node*/
+struct ClipCompressionReport
+{
+	size_t rawSize = 0;
+	size_t compressedSize = 0;
+	size_t rawKeyCount = 0;
+	size_t compressedKeyCount = 0;
+
+	/*distance between the node's model space position sampled from the raw and the compressed keys*/
+	std::vector<float> maxPositionError;
+
+	/*angle in radians between the node's local rotations sampled from the raw and the compressed keys*/
+	std::vector<float> maxRotationError;
+
+	/*times the keys were reduced before every node was within the position tolerance (or the limit was reached)*/
+	int passes = 0;
+
+	float GetRatio() const { return compressedSize > 0 ? float(rawSize) / float(compressedSize) : 0.0f; }
+};
+
+/*Key reduction tolerances of one channel: position and scale in their own units, rotation in radians*/
+struct ChannelTolerance
+{
+	float position = 0.001f;
+	float rotation = 0.0005f;
+	float scale = 0.001f;
+};
+
+/*Every key that linear interpolation of its neighbours reproduces within a tolerance is dropped, and the remaining
+keys are quantized to 16 bit integers:
+	time      16 bits, relative to the clip duration
+	rotation  48 bits, smallest three: index of the largest component (2 bits) and the other three (15 bits each)
+	position  3 x 16 bits, relative to the range of the track
+	scale     3 x 16 bits, relative to the range of the track
+All tracks of all channels live in one contiguous blob, times and values of a track in separate runs (SoA), so
+sampling a track walks two short arrays.
+An empty track is stored as a single identity key, so every track holds at least one key.*/
+class CompressedClip
+{
+public:
+	CompressedClip() = default;
+
+	/*One tolerance per bone, bounding the local error of the key reduction of its tracks*/
+	CompressedClip(const std::vector<Bone>& bones, float duration, const std::vector<ChannelTolerance>& tolerances)
+	{
+		m_TimeScale = duration > 0.0f ? 65535.0f / duration : 0.0f;
+
+		for (size_t b = 0; b < bones.size(); ++b)
+		{
+			const Bone& bone = bones[b];
+			const ChannelTolerance& tolerance = tolerances[b];
+			ChannelTracks channel;
+
+			std::vector<float> times;
+			std::vector<glm::vec3> vectors;
+			for (const KeyPosition& key : bone.GetPositionKeys())
+			{
+				times.push_back(key.timeStamp);
+				vectors.push_back(key.position);
+			}
+			AddIdentityKey(times, vectors, glm::vec3(0.0f));
+			channel.position = AddVectorTrack(times, vectors, tolerance.position);
+
+			times.clear();
+			std::vector<glm::quat> rotations;
+			for (const KeyRotation& key : bone.GetRotationKeys())
+			{
+				times.push_back(key.timeStamp);
+				rotations.push_back(glm::normalize(key.orientation));
+			}
+			AddIdentityKey(times, rotations, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+			channel.rotation = AddRotationTrack(times, rotations, tolerance.rotation);
+
+			times.clear();
+			vectors.clear();
+			for (const KeyScale& key : bone.GetScaleKeys())
+			{
+				times.push_back(key.timeStamp);
+				vectors.push_back(key.scale);
+			}
+			AddIdentityKey(times, vectors, glm::vec3(1.0f));
+			channel.scale = AddVectorTrack(times, vectors, tolerance.scale);
+
+			m_Channels.push_back(channel);
+		}
+		m_Data.shrink_to_fit();
+	}
+
+	BonePose SamplePose(int channel, float animationTime, BoneCursor& cursor) const
+	{
+		const ChannelTracks& tracks = m_Channels[channel];
+		const float time = glm::clamp(animationTime * m_TimeScale, 0.0f, 65535.0f);
+
+		BonePose pose;
+		pose.position = SampleVector(tracks.position, time, cursor.position);
+		pose.rotation = SampleRotation(tracks.rotation, time, cursor.rotation);
+		pose.scale = SampleVector(tracks.scale, time, cursor.scale);
+		return pose;
+	}
+
+	/*Bytes used by the keys and the track descriptions*/
+	size_t GetSize() const
+	{
+		return m_Data.size() * sizeof(std::uint16_t) + m_Channels.size() * sizeof(ChannelTracks);
+	}
+
+	size_t GetKeyCount() const
+	{
+		size_t keyCount = 0;
+		for (const ChannelTracks& channel : m_Channels)
+			keyCount += channel.position.keyCount + channel.rotation.keyCount + channel.scale.keyCount;
+		return keyCount;
+	}
+
+	bool IsEmpty() const { return m_Channels.empty(); }
+
+	/*The quantized times and values of every track, e.g. to hash the clip*/
+	const std::vector<std::uint16_t>& GetData() const { return m_Data; }
+
+	/*Angle in radians of the rotation between a and b. acos(dot) can't resolve the small angles of the tolerances.*/
+	static float GetAngle(const glm::quat& a, const glm::quat& b)
+	{
+		const glm::quat difference = glm::conjugate(a) * b;
+		return 2.0f * std::atan2(glm::length(glm::vec3(difference.x, difference.y, difference.z)), std::abs(difference.w));
+	}
+
+private:
+	struct Track
+	{
+		std::uint32_t timeOffset = 0;
+		std::uint32_t valueOffset = 0;
+		std::uint32_t keyCount = 0;
+		/*dequantization range of position and scale tracks*/
+		glm::vec3 min = glm::vec3(0.0f);
+		glm::vec3 extent = glm::vec3(0.0f);
+	};
+
+	struct ChannelTracks
+	{
+		Track position;
+		Track rotation;
+		Track scale;
+	};
+
+	template<typename TValue>
+	static void AddIdentityKey(std::vector<float>& times, std::vector<TValue>& values, const TValue& identity)
+	{
+		if (times.empty())
+		{
+			times.push_back(0.0f);
+			values.push_back(identity);
+		}
+	}
+
+	/*Greedy key reduction: extend the segment starting at the last kept key as long as interpolating its end points
+	reproduces every key in between within tolerance*/
+	template<typename TValue, typename TInterpolate, typename TError>
+	static std::vector<int> ReduceKeys(const std::vector<float>& times, const std::vector<TValue>& values, float tolerance,
+		TInterpolate interpolate, TError error)
+	{
+		std::vector<int> kept;
+		const int count = static_cast<int>(times.size());
+		if (count == 0)
+			return kept;
+
+		kept.push_back(0);
+		int start = 0;
+		for (int end = 2; end < count; ++end)
+		{
+			bool reproduced = true;
+			for (int i = start + 1; i < end && reproduced; ++i)
+			{
+				const float span = times[end] - times[start];
+				const float factor = span > 0.0f ? (times[i] - times[start]) / span : 0.0f;
+				reproduced = error(interpolate(values[start], values[end], factor), values[i]) <= tolerance;
+			}
+
+			if (!reproduced)
+			{
+				start = end - 1;
+				kept.push_back(start);
+			}
+		}
+		if (count > 1)
+			kept.push_back(count - 1);
+
+		//a constant track only needs one key
+		bool constant = true;
+		for (int i = 1; i < count && constant; ++i)
+			constant = error(values[0], values[i]) <= tolerance;
+		if (constant)
+			kept.resize(1);
+		return kept;
+	}
+
+	void AddTimes(Track& track, const std::vector<float>& times, const std::vector<int>& kept)
+	{
+		track.timeOffset = static_cast<std::uint32_t>(m_Data.size());
+		track.keyCount = static_cast<std::uint32_t>(kept.size());
+		for (int key : kept)
+			m_Data.push_back(static_cast<std::uint16_t>(std::lround(glm::clamp(times[key] * m_TimeScale, 0.0f, 65535.0f))));
+	}
+
+	Track AddVectorTrack(const std::vector<float>& times, const std::vector<glm::vec3>& values, float tolerance)
+	{
+		const std::vector<int> kept = ReduceKeys(times, values, tolerance,
+			[](const glm::vec3& a, const glm::vec3& b, float factor) { return glm::mix(a, b, factor); },
+			[](const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); });
+
+		Track track;
+		AddTimes(track, times, kept);
+
+		glm::vec3 max(-std::numeric_limits<float>::max());
+		track.min = glm::vec3(std::numeric_limits<float>::max());
+		for (int key : kept)
+		{
+			track.min = glm::min(track.min, values[key]);
+			max = glm::max(max, values[key]);
+		}
+		track.extent = kept.empty() ? glm::vec3(0.0f) : max - track.min;
+
+		track.valueOffset = static_cast<std::uint32_t>(m_Data.size());
+		for (int key : kept)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float normalized = track.extent[axis] > 0.0f ? (values[key][axis] - track.min[axis]) / track.extent[axis] : 0.0f;
+				m_Data.push_back(static_cast<std::uint16_t>(std::lround(glm::clamp(normalized, 0.0f, 1.0f) * 65535.0f)));
+			}
+		}
+		return track;
+	}
+
+	Track AddRotationTrack(const std::vector<float>& times, const std::vector<glm::quat>& values, float tolerance)
+	{
+		const std::vector<int> kept = ReduceKeys(times, values, tolerance,
+			[](const glm::quat& a, const glm::quat& b, float factor) { return glm::normalize(glm::slerp(a, b, factor)); },
+			[](const glm::quat& a, const glm::quat& b) { return GetAngle(a, b); });
+
+		Track track;
+		AddTimes(track, times, kept);
+
+		track.valueOffset = static_cast<std::uint32_t>(m_Data.size());
+		for (int key : kept)
+		{
+			std::uint16_t packed[3];
+			PackRotation(values[key], packed);
+			m_Data.insert(m_Data.end(), packed, packed + 3);
+		}
+		return track;
+	}
+
+	/*The largest component is rebuilt from the unit length, the other three are within +-1/sqrt(2)*/
+	static void PackRotation(glm::quat rotation, std::uint16_t packed[3])
+	{
+		const float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+		int largest = 0;
+		for (int i = 1; i < 4; ++i)
+		{
+			if (std::abs(components[i]) > std::abs(components[largest]))
+				largest = i;
+		}
+		const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+		std::uint64_t bits = static_cast<std::uint64_t>(largest);
+		int shift = 2;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			const float normalized = (components[i] * sign * SQRT2 + 1.0f) * 0.5f;
+			bits |= static_cast<std::uint64_t>(std::lround(glm::clamp(normalized, 0.0f, 1.0f) * 32767.0f)) << shift;
+			shift += 15;
+		}
+		packed[0] = static_cast<std::uint16_t>(bits);
+		packed[1] = static_cast<std::uint16_t>(bits >> 16);
+		packed[2] = static_cast<std::uint16_t>(bits >> 32);
+	}
+
+	static glm::quat UnpackRotation(const std::uint16_t* packed)
+	{
+		const std::uint64_t bits = static_cast<std::uint64_t>(packed[0]) | static_cast<std::uint64_t>(packed[1]) << 16 |
+			static_cast<std::uint64_t>(packed[2]) << 32;
+		const int largest = static_cast<int>(bits & 3);
+
+		float components[4];
+		float sumOfSquares = 0.0f;
+		int shift = 2;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			components[i] = (((bits >> shift) & 0x7FFF) / 32767.0f * 2.0f - 1.0f) / SQRT2;
+			sumOfSquares += components[i] * components[i];
+			shift += 15;
+		}
+		components[largest] = std::sqrt(std::max(0.0f, 1.0f - sumOfSquares));
+		return glm::normalize(glm::quat(components[3], components[0], components[1], components[2]));
+	}
+
+	glm::vec3 DecodeVector(const Track& track, std::uint32_t key) const
+	{
+		const std::uint16_t* quantized = &m_Data[track.valueOffset + key * 3];
+		return track.min + track.extent * glm::vec3(quantized[0], quantized[1], quantized[2]) * (1.0f / 65535.0f);
+	}
+
+	/*Same search as Bone: the cursor's interval, the next one, then a binary search*/
+	int FindKeyIndex(const Track& track, float time, int& cursor) const
+	{
+		const std::uint16_t* times = &m_Data[track.timeOffset];
+		const int lastIndex = static_cast<int>(track.keyCount) - 2;
+		if (lastIndex < 0 || time <= times[0])
+			return cursor = 0;
+		if (time >= times[lastIndex + 1])
+			return cursor = lastIndex;
+
+		int index = std::min(cursor, lastIndex);
+		if (time >= times[index])
+		{
+			if (time < times[index + 1])
+				return cursor = index;
+			if (index + 1 <= lastIndex && time < times[index + 2])
+				return cursor = index + 1;
+		}
+
+		const std::uint16_t* next = std::upper_bound(times, times + track.keyCount, time,
+			[](float value, std::uint16_t keyTime) { return value < keyTime; });
+		return cursor = static_cast<int>(next - times) - 1;
+	}
+
+	float GetFactor(const Track& track, int index, float time) const
+	{
+		const float start = m_Data[track.timeOffset + index];
+		const float span = m_Data[track.timeOffset + index + 1] - start;
+		return span > 0.0f ? glm::clamp((time - start) / span, 0.0f, 1.0f) : 0.0f;
+	}
+
+	glm::vec3 SampleVector(const Track& track, float time, int& cursor) const
+	{
+		if (track.keyCount == 1)
+			return DecodeVector(track, 0);
+
+		const int index = FindKeyIndex(track, time, cursor);
+		return glm::mix(DecodeVector(track, index), DecodeVector(track, index + 1), GetFactor(track, index, time));
+	}
+
+	glm::quat SampleRotation(const Track& track, float time, int& cursor) const
+	{
+		const std::uint16_t* values = &m_Data[track.valueOffset];
+		if (track.keyCount == 1)
+			return UnpackRotation(values);
+
+		const int index = FindKeyIndex(track, time, cursor);
+		return glm::normalize(glm::slerp(UnpackRotation(values + index * 3), UnpackRotation(values + (index + 1) * 3),
+			GetFactor(track, index, time)));
+	}
+
+	static constexpr float SQRT2 = 1.41421356f;
+
+	float m_TimeScale = 0.0f;
+	std::vector<ChannelTracks> m_Channels;
+	std::vector<std::uint16_t> m_Data;
+};
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#define GLM_ENABLE_EXPERIMENTAL
+#endif
+#include <glm/gtx/dual_quaternion.hpp>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <learnopengl/model_animation.h>
+#include <learnopengl/thread_pool.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CPU_SKINNING_AVX2 1
+#define CPU_SKINNING_AVX2_TARGET __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && defined(__AVX2__)
+#include <immintrin.h>
+#define CPU_SKINNING_AVX2 1
+#define CPU_SKINNING_AVX2_TARGET
+#endif
+
+enum class SkinningKernel
+{
+	Scalar,
+
+	/*8 vertices at a time, only used when the CPU supports it (see CpuSkinner::IsAvx2Supported)*/
+	Avx2
+};
+
+/*Skins the vertices of a Model on the CPU, with the same weighted sum as the skinning vertex shaders, for
+software rendering, validation, or physics and ray casts against animated meshes.
+The bind pose is kept as a structure of arrays (one array per component and per influence) padded to a multiple
+of 8 vertices, so the AVX2 kernel skins 8 vertices per iteration with no tail. The output is laid out the same way:
+vertex v of the model (its meshes' vertices one after the other) is at index v of GetPositions(axis).*/
+class CpuSkinner
+{
+public:
+	explicit CpuSkinner(const Model& model)
+	{
+		for (const Mesh& mesh : model.meshes)
+			m_VertexCount += mesh.vertices.size();
+		m_PaddedCount = (m_VertexCount + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			m_BindPositions[axis].assign(m_PaddedCount, 0.0f);
+			m_BindNormals[axis].assign(m_PaddedCount, 0.0f);
+			m_Positions[axis].assign(m_PaddedCount, 0.0f);
+			m_Normals[axis].assign(m_PaddedCount, 0.0f);
+		}
+		for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+		{
+			m_PaletteOffsets[i].assign(m_PaddedCount, 0);
+			m_Weights[i].assign(m_PaddedCount, 0.0f);
+		}
+
+		std::size_t v = 0;
+		for (const Mesh& mesh : model.meshes)
+		{
+			for (const Vertex& vertex : mesh.vertices)
+			{
+				for (int axis = 0; axis < 3; axis++)
+				{
+					m_BindPositions[axis][v] = vertex.Position[axis];
+					m_BindNormals[axis][v] = vertex.Normal[axis];
+				}
+				//unused influences become bone 0 with weight 0, so the kernels don't branch
+				for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+				{
+					if (vertex.m_BoneIDs[i] == -1)
+						continue;
+					m_PaletteOffsets[i][v] = vertex.m_BoneIDs[i] * 16;
+					m_Weights[i][v] = vertex.m_Weights[i];
+				}
+				v++;
+			}
+		}
+	}
+
+	/*Reference skinning of a single vertex, w is the sum of the weights*/
+	static glm::vec4 SkinVertex(const Vertex& vertex, const glm::mat4* palette)
+	{
+		glm::vec4 position(0.0f);
+		for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+		{
+			if (vertex.m_BoneIDs[i] == -1)
+				continue;
+			position += palette[vertex.m_BoneIDs[i]] * glm::vec4(vertex.Position, 1.0f) * vertex.m_Weights[i];
+		}
+		return position;
+	}
+
+	static glm::vec3 SkinNormal(const Vertex& vertex, const glm::mat4* palette)
+	{
+		glm::vec3 normal(0.0f);
+		for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+		{
+			if (vertex.m_BoneIDs[i] == -1)
+				continue;
+			normal += glm::mat3(palette[vertex.m_BoneIDs[i]]) * vertex.Normal * vertex.m_Weights[i];
+		}
+		return glm::length(normal) > 0.0f ? glm::normalize(normal) : normal;
+	}
+
+	/*Dual quaternion skinning of a single vertex: the bone dual quaternions are blended (in the hemisphere of the
+	first influence) and normalized, then applied as one rigid transform, which keeps twisted joints from collapsing.
+	Matches linear blend skinning when every influence of the vertex moves rigidly with the same transform.*/
+	static glm::vec3 SkinVertex(const Vertex& vertex, const glm::dualquat* palette, glm::vec3* normal = nullptr)
+	{
+		glm::dualquat blended(glm::quat(0.0f, 0.0f, 0.0f, 0.0f), glm::quat(0.0f, 0.0f, 0.0f, 0.0f));
+		const glm::quat* pivot = nullptr;
+		for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+		{
+			if (vertex.m_BoneIDs[i] == -1)
+				continue;
+
+			const glm::dualquat& bone = palette[vertex.m_BoneIDs[i]];
+			if (!pivot)
+				pivot = &bone.real;
+			const float weight = glm::dot(*pivot, bone.real) < 0.0f ? -vertex.m_Weights[i] : vertex.m_Weights[i];
+			blended.real += bone.real * weight;
+			blended.dual += bone.dual * weight;
+		}
+
+		const float length = glm::length(blended.real);
+		if (length == 0.0f)
+		{
+			if (normal)
+				*normal = glm::vec3(0.0f);
+			return glm::vec3(0.0f);
+		}
+		blended.real /= length;
+		blended.dual /= length;
+
+		if (normal)
+			*normal = glm::normalize(blended.real * vertex.Normal);
+		return blended * vertex.Position;
+	}
+
+	static bool IsAvx2Supported()
+	{
+#if defined(CPU_SKINNING_AVX2) && !defined(_MSC_VER)
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(CPU_SKINNING_AVX2)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/*Skin every vertex with palette (one matrix per bone id). The vertices are split in chunks over the workers of
+	threadPool when one is given. Asking for AVX2 on a CPU without it falls back to the scalar kernel.*/
+	void Skin(const glm::mat4* palette, ThreadPool* threadPool = nullptr, SkinningKernel kernel = SkinningKernel::Avx2)
+	{
+		const float* paletteData = &palette[0][0][0];
+		const bool useAvx2 = kernel == SkinningKernel::Avx2 && IsAvx2Supported();
+		auto skinRange = [&](std::size_t begin, std::size_t end, unsigned int)
+		{
+#ifdef CPU_SKINNING_AVX2
+			if (useAvx2)
+			{
+				SkinAvx2(paletteData, begin * SIMD_WIDTH, end * SIMD_WIDTH);
+				return;
+			}
+#endif
+			SkinScalar(paletteData, begin * SIMD_WIDTH, end * SIMD_WIDTH);
+		};
+
+		const std::size_t blockCount = m_PaddedCount / SIMD_WIDTH;
+		if (threadPool)
+			threadPool->ParallelFor(blockCount, CHUNK_SIZE / SIMD_WIDTH, skinRange);
+		else
+			skinRange(0, blockCount, 0);
+	}
+
+	glm::vec3 GetPosition(std::size_t vertex) const { return glm::vec3(m_Positions[0][vertex], m_Positions[1][vertex], m_Positions[2][vertex]); }
+	glm::vec3 GetNormal(std::size_t vertex) const { return glm::vec3(m_Normals[0][vertex], m_Normals[1][vertex], m_Normals[2][vertex]); }
+	const float* GetPositions(int axis) const { return m_Positions[axis].data(); }
+	const float* GetNormals(int axis) const { return m_Normals[axis].data(); }
+	std::size_t GetVertexCount() const { return m_VertexCount; }
+
+private:
+	static const std::size_t SIMD_WIDTH = 8;
+
+	/*Vertices per task of the thread pool*/
+	static const std::size_t CHUNK_SIZE = 2048;
+
+	void SkinScalar(const float* palette, std::size_t begin, std::size_t end)
+	{
+		const float* bindPositions[3] = { m_BindPositions[0].data(), m_BindPositions[1].data(), m_BindPositions[2].data() };
+		const float* bindNormals[3] = { m_BindNormals[0].data(), m_BindNormals[1].data(), m_BindNormals[2].data() };
+		float* positions[3] = { m_Positions[0].data(), m_Positions[1].data(), m_Positions[2].data() };
+		float* normals[3] = { m_Normals[0].data(), m_Normals[1].data(), m_Normals[2].data() };
+		const float* weights[MAX_BONE_INFLUENCE];
+		const int* paletteOffsets[MAX_BONE_INFLUENCE];
+		for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+		{
+			weights[i] = m_Weights[i].data();
+			paletteOffsets[i] = m_PaletteOffsets[i].data();
+		}
+
+		for (std::size_t v = begin; v < end; v++)
+		{
+			const float px = bindPositions[0][v], py = bindPositions[1][v], pz = bindPositions[2][v];
+			const float nx = bindNormals[0][v], ny = bindNormals[1][v], nz = bindNormals[2][v];
+			float position[3] = { 0.0f, 0.0f, 0.0f };
+			float normal[3] = { 0.0f, 0.0f, 0.0f };
+			for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+			{
+				const float w = weights[i][v];
+				if (w == 0.0f)
+					continue;
+
+				const float* m = palette + paletteOffsets[i][v];
+				for (int row = 0; row < 3; row++)
+				{
+					position[row] += w * (m[row] * px + m[4 + row] * py + m[8 + row] * pz + m[12 + row]);
+					normal[row] += w * (m[row] * nx + m[4 + row] * ny + m[8 + row] * nz);
+				}
+			}
+
+			const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			const float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+			for (int row = 0; row < 3; row++)
+			{
+				positions[row][v] = position[row];
+				normals[row][v] = normal[row] * inverseLength;
+			}
+		}
+	}
+
+#ifdef CPU_SKINNING_AVX2
+	/*Same computation as SkinScalar on 8 vertices at a time, the matrix entries of the 8 bones are gathered*/
+	CPU_SKINNING_AVX2_TARGET void SkinAvx2(const float* palette, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t v = begin; v < end; v += SIMD_WIDTH)
+		{
+			const __m256 px = _mm256_loadu_ps(&m_BindPositions[0][v]);
+			const __m256 py = _mm256_loadu_ps(&m_BindPositions[1][v]);
+			const __m256 pz = _mm256_loadu_ps(&m_BindPositions[2][v]);
+			const __m256 nx = _mm256_loadu_ps(&m_BindNormals[0][v]);
+			const __m256 ny = _mm256_loadu_ps(&m_BindNormals[1][v]);
+			const __m256 nz = _mm256_loadu_ps(&m_BindNormals[2][v]);
+			__m256 position[3] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+			__m256 normal[3] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+
+			for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+			{
+				//most vertices have fewer than 4 influences, skip the gathers when none of the 8 has this one
+				const __m256 w = _mm256_loadu_ps(&m_Weights[i][v]);
+				if (_mm256_movemask_ps(_mm256_cmp_ps(w, _mm256_setzero_ps(), _CMP_NEQ_OQ)) == 0)
+					continue;
+
+				const __m256i offsets = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_PaletteOffsets[i][v]));
+				for (int row = 0; row < 3; row++)
+				{
+					const __m256 m0 = _mm256_i32gather_ps(palette + row, offsets, 4);
+					const __m256 m1 = _mm256_i32gather_ps(palette + 4 + row, offsets, 4);
+					const __m256 m2 = _mm256_i32gather_ps(palette + 8 + row, offsets, 4);
+					const __m256 m3 = _mm256_i32gather_ps(palette + 12 + row, offsets, 4);
+
+					const __m256 p = _mm256_fmadd_ps(m0, px, _mm256_fmadd_ps(m1, py, _mm256_fmadd_ps(m2, pz, m3)));
+					const __m256 n = _mm256_fmadd_ps(m0, nx, _mm256_fmadd_ps(m1, ny, _mm256_mul_ps(m2, nz)));
+					position[row] = _mm256_fmadd_ps(w, p, position[row]);
+					normal[row] = _mm256_fmadd_ps(w, n, normal[row]);
+				}
+			}
+
+			const __m256 lengthSquared = _mm256_fmadd_ps(normal[0], normal[0], _mm256_fmadd_ps(normal[1], normal[1], _mm256_mul_ps(normal[2], normal[2])));
+			const __m256 length = _mm256_sqrt_ps(lengthSquared);
+			const __m256 nonZero = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ);
+			const __m256 inverseLength = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), length), nonZero);
+			for (int row = 0; row < 3; row++)
+			{
+				_mm256_storeu_ps(&m_Positions[row][v], position[row]);
+				_mm256_storeu_ps(&m_Normals[row][v], _mm256_mul_ps(normal[row], inverseLength));
+			}
+		}
+	}
+#endif
+
+	std::size_t m_VertexCount = 0;
+	std::size_t m_PaddedCount = 0;
+
+	std::vector<float> m_BindPositions[3];
+	std::vector<float> m_BindNormals[3];
+
+	/*bone id * 16, the offset of the bone matrix in the palette*/
+	std::vector<int> m_PaletteOffsets[MAX_BONE_INFLUENCE];
+	std::vector<float> m_Weights[MAX_BONE_INFLUENCE];
+
+	std::vector<float> m_Positions[3];
+	std::vector<float> m_Normals[3];
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <vector>
+#include <learnopengl/animation.h>
+#include <learnopengl/bone.h>
+#include <learnopengl/thread_pool.h>
+
+/*One animation level of detail, used by the instances at least distance away from the camera*/
+struct AnimationLodLevel
+{
+	float distance;
+
+	/*frames between two evaluations, the palettes of the frames in between are interpolated*/
+	int updateInterval;
+
+	/*nodes closer than this to the end of their chain keep their bind pose (see Animation::Evaluate)*/
+	int minLeafDistance;
+};
+
+/*What the last UpdateAnimation did, to compare the work done with evaluating every instance in full*/
+struct AnimationLodStats
+{
+	int evaluatedInstances = 0;
+	int interpolatedInstances = 0;
+	int frozenInstances = 0;
+	int sampledChannels = 0;
+
+	/*channels a full rate, full skeleton update of every instance would have sampled*/
+	int fullChannels = 0;
+
+	float GetSavedFraction() const { return fullChannels > 0 ? 1.0f - static_cast<float>(sampledChannels) / fullChannels : 0.0f; }
+};
+
+/*Plays one Animation on many characters.
+The Animation holds the shared, read only clip data (skeleton and keyframes). Each instance only owns its time,
+speed and keyframe cursors. The palettes of all instances are written back to back into one contiguous buffer,
+instance i starting at matrix i * GetPaletteSize(), ready to be uploaded with a single buffer update.
+Distant instances are evaluated less often and with fewer bones, hidden instances aren't evaluated at all
+(see SetLodLevels and SetInstanceVisibility).*/
+class CrowdAnimator
+{
+public:
+	CrowdAnimator(Animation* animation, ThreadPool& threadPool)
+		: m_Animation(animation), m_ThreadPool(threadPool)
+	{
+		m_PaletteSize = animation->GetBoneCount();
+		m_ChannelCount = static_cast<int>(animation->GetBones().size());
+		m_FullChannelCount = animation->CountSampledChannels(0);
+		m_WorkerGlobalTransforms.resize(threadPool.GetWorkerCount());
+		for (std::vector<glm::mat4>& globalTransforms : m_WorkerGlobalTransforms)
+			globalTransforms.resize(animation->GetSkeleton().size());
+		m_WorkerStats.resize(threadPool.GetWorkerCount());
+		SetLodLevels({ { 0.0f, 1, 0 }, { 10.0f, 2, 0 }, { 25.0f, 4, 1 }, { 50.0f, 8, 2 } });
+	}
+
+	/*Returns the index of the new instance*/
+	int AddInstance(float startTime = 0.0f, float speed = 1.0f)
+	{
+		Instance instance;
+		instance.time = std::fmod(startTime, m_Animation->GetDuration());
+		instance.speed = speed;
+		m_Instances.push_back(instance);
+		m_Cursors.resize(m_Instances.size() * m_ChannelCount);
+		m_Palettes.resize(m_Instances.size() * m_PaletteSize, glm::mat4(1.0f));
+		m_TargetPalettes.resize(m_Instances.size() * m_PaletteSize, glm::mat4(1.0f));
+		return static_cast<int>(m_Instances.size()) - 1;
+	}
+
+	/*Levels sorted by increasing distance, the first one is used for every instance closer than the second one*/
+	void SetLodLevels(const std::vector<AnimationLodLevel>& levels)
+	{
+		m_LodLevels = levels;
+		for (Instance& instance : m_Instances)
+			instance.lodLevel = 0;
+	}
+
+	/*Select the level of detail of an instance from its distance to the camera. A hidden (e.g. frustum culled)
+	instance keeps its last palette and is evaluated again as soon as it is visible.*/
+	void SetInstanceVisibility(int instance, float cameraDistance, bool visible)
+	{
+		Instance& target = m_Instances[instance];
+		int lodLevel = 0;
+		while (lodLevel + 1 < static_cast<int>(m_LodLevels.size()) && cameraDistance >= m_LodLevels[lodLevel + 1].distance)
+			lodLevel++;
+
+		if (lodLevel != target.lodLevel)
+		{
+			target.lodLevel = lodLevel;
+			target.remainingFrames = 0;
+		}
+		if (visible && !target.visible)
+			target.needsPose = true;
+		target.visible = visible;
+	}
+
+	/*Advance every instance and evaluate or interpolate the visible ones, spread over the workers of the thread pool*/
+	void UpdateAnimation(float dt)
+	{
+		const float ticks = m_Animation->GetTicksPerSecond() * dt;
+		const float duration = m_Animation->GetDuration();
+		for (AnimationLodStats& stats : m_WorkerStats)
+			stats = AnimationLodStats();
+
+		m_ThreadPool.ParallelFor(m_Instances.size(), GRAIN_SIZE, [&](std::size_t begin, std::size_t end, unsigned int workerIndex)
+		{
+			glm::mat4* globalTransforms = m_WorkerGlobalTransforms[workerIndex].data();
+			AnimationLodStats& stats = m_WorkerStats[workerIndex];
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				Instance& instance = m_Instances[i];
+				instance.time = std::fmod(instance.time + ticks * instance.speed, duration);
+				stats.fullChannels += m_FullChannelCount;
+				if (!instance.visible)
+				{
+					stats.frozenInstances++;
+					continue;
+				}
+
+				const AnimationLodLevel& level = m_LodLevels[instance.lodLevel];
+				BoneCursor* cursors = &m_Cursors[i * m_ChannelCount];
+				glm::mat4* palette = &m_Palettes[i * m_PaletteSize];
+				glm::mat4* targetPalette = &m_TargetPalettes[i * m_PaletteSize];
+
+				if (level.updateInterval <= 1 || instance.needsPose)
+				{
+					stats.sampledChannels += m_Animation->Evaluate(instance.time, cursors, globalTransforms, palette, level.minLeafDistance);
+					stats.evaluatedInstances++;
+					instance.needsPose = false;
+					instance.remainingFrames = 0;
+					continue;
+				}
+
+				if (instance.remainingFrames == 0)
+				{
+					//evaluate the pose at the end of the interval, the palette is then interpolated towards it frame by frame.
+					//Intervals are staggered by instance so the evaluations are spread evenly over the frames.
+					const int intervalFrames = level.updateInterval - static_cast<int>((m_FrameIndex + i) % level.updateInterval);
+					const float targetTime = std::fmod(instance.time + ticks * instance.speed * (intervalFrames - 1), duration);
+					stats.sampledChannels += m_Animation->Evaluate(targetTime, cursors, globalTransforms, targetPalette, level.minLeafDistance);
+					stats.evaluatedInstances++;
+					instance.remainingFrames = intervalFrames;
+				}
+				else
+				{
+					stats.interpolatedInstances++;
+				}
+
+				const float t = 1.0f / instance.remainingFrames;
+				for (int bone = 0; bone < m_PaletteSize; ++bone)
+					palette[bone] += (targetPalette[bone] - palette[bone]) * t;
+				instance.remainingFrames--;
+			}
+		});
+		m_FrameIndex++;
+
+		m_Stats = AnimationLodStats();
+		for (const AnimationLodStats& stats : m_WorkerStats)
+		{
+			m_Stats.evaluatedInstances += stats.evaluatedInstances;
+			m_Stats.interpolatedInstances += stats.interpolatedInstances;
+			m_Stats.frozenInstances += stats.frozenInstances;
+			m_Stats.sampledChannels += stats.sampledChannels;
+			m_Stats.fullChannels += stats.fullChannels;
+		}
+	}
+
+	const std::vector<glm::mat4>& GetPalettes() const { return m_Palettes; }
+	const glm::mat4* GetPalette(int instance) const { return &m_Palettes[instance * m_PaletteSize]; }
+	int GetPaletteSize() const { return m_PaletteSize; }
+	int GetInstanceCount() const { return static_cast<int>(m_Instances.size()); }
+	int GetInstanceLod(int instance) const { return m_Instances[instance].lodLevel; }
+	const AnimationLodStats& GetLodStats() const { return m_Stats; }
+
+private:
+	/*Instances per task: small enough to balance the workers, large enough to amortize the queue locking*/
+	static const std::size_t GRAIN_SIZE = 8;
+
+	struct Instance
+	{
+		float time;
+		float speed;
+		int lodLevel = 0;
+		bool visible = true;
+
+		/*evaluate the current pose on the next update instead of interpolating from a stale palette*/
+		bool needsPose = true;
+
+		/*updates left before the palette reaches the target palette*/
+		int remainingFrames = 0;
+	};
+
+	Animation* m_Animation;
+	ThreadPool& m_ThreadPool;
+	int m_PaletteSize;
+	int m_ChannelCount;
+	/*channels of the whole skeleton, what a full update samples whatever the first LOD level skips*/
+	int m_FullChannelCount;
+
+	std::vector<Instance> m_Instances;
+	std::vector<BoneCursor> m_Cursors;
+	std::vector<glm::mat4> m_Palettes;
+	std::vector<glm::mat4> m_TargetPalettes;
+	std::vector<std::vector<glm::mat4>> m_WorkerGlobalTransforms;
+
+	std::vector<AnimationLodLevel> m_LodLevels;
+	std::vector<AnimationLodStats> m_WorkerStats;
+	AnimationLodStats m_Stats;
+	std::size_t m_FrameIndex = 0;
+};
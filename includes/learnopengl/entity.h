@@ -2,49 +2,80 @@
 #define ENTITY_H
 
 #include <glm/glm.hpp> //glm::mat4
-#include <list> //std::list
+#include <glm/gtc/quaternion.hpp> //glm::quat
 #include <array> //std::array
+#include <cmath> //std::atan2
+#include <cstdint> //std::uint32_t
 #include <memory> //std::unique_ptr
+#include <vector> //std::vector
+#include <learnopengl/chunked_pool.h> //ChunkedPool
 
 class Transform
 {
 protected:
 	//Local space information
 	glm::vec3 m_pos = { 0.0f, 0.0f, 0.0f };
-	glm::vec3 m_eulerRot = { 0.0f, 0.0f, 0.0f }; //In degrees
+	glm::quat m_rot = { 1.0f, 0.0f, 0.0f, 0.0f };
+	glm::vec3 m_eulerRot = { 0.0f, 0.0f, 0.0f }; //In degrees, only kept for the Euler convenience API
 	glm::vec3 m_scale = { 1.0f, 1.0f, 1.0f };
 
 	//Global space information concatenate in matrix
 	glm::mat4 m_modelMatrix = glm::mat4(1.0f);
 
-	//Dirty flag
+	//Global space information derived from the model matrix, cached when it is computed
+	glm::vec3 m_globalScale = { 1.0f, 1.0f, 1.0f };
+	mutable glm::mat4 m_inverseModelMatrix = glm::mat4(1.0f);
+
+	//Dirty flags
 	bool m_isDirty = true;
+	mutable bool m_isInverseDirty = false;
+
+	//Incremented every time the model matrix is recomputed, lets observers detect moves
+	std::uint32_t m_version = 0;
 
 protected:
-	glm::mat4 getLocalModelMatrix()
+	// translation * rotation * scale (also know as TRS matrix), written directly as a 4x3 affine matrix.
+	// The rotation comes straight from the quaternion so no intermediate rotation matrix is multiplied.
+	glm::mat4x3 getLocalModelMatrix() const
 	{
-		const glm::mat4 transformX = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.x), glm::vec3(1.0f, 0.0f, 0.0f));
-		const glm::mat4 transformY = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.y), glm::vec3(0.0f, 1.0f, 0.0f));
-		const glm::mat4 transformZ = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		const glm::mat3 rotation = glm::mat3_cast(m_rot);
+		return glm::mat4x3(rotation[0] * m_scale.x, rotation[1] * m_scale.y, rotation[2] * m_scale.z, m_pos);
+	}
 
-		// Y * X * Z
-		const glm::mat4 rotationMatrix = transformY * transformX * transformZ;
+	//Affine product parent * local. The last row of both matrices is known to be (0, 0, 0, 1) so it is skipped.
+	static glm::mat4 composeAffine(const glm::mat4& parent, const glm::mat4x3& local)
+	{
+		const glm::vec3 px(parent[0]), py(parent[1]), pz(parent[2]), pt(parent[3]);
 
-		// translation * rotation * scale (also know as TRS matrix)
-		return glm::translate(glm::mat4(1.0f), m_pos) * rotationMatrix * glm::scale(glm::mat4(1.0f), m_scale);
+		glm::mat4 result;
+		result[0] = glm::vec4(px * local[0].x + py * local[0].y + pz * local[0].z, 0.0f);
+		result[1] = glm::vec4(px * local[1].x + py * local[1].y + pz * local[1].z, 0.0f);
+		result[2] = glm::vec4(px * local[2].x + py * local[2].y + pz * local[2].z, 0.0f);
+		result[3] = glm::vec4(px * local[3].x + py * local[3].y + pz * local[3].z + pt, 1.0f);
+		return result;
 	}
+
+	void onModelMatrixChanged()
+	{
+		m_globalScale = { glm::length(glm::vec3(m_modelMatrix[0])), glm::length(glm::vec3(m_modelMatrix[1])), glm::length(glm::vec3(m_modelMatrix[2])) };
+		m_isInverseDirty = true;
+		m_isDirty = false;
+		++m_version;
+	}
+
 public:
 
 	void computeModelMatrix()
 	{
-		m_modelMatrix = getLocalModelMatrix();
-		m_isDirty = false;
+		const glm::mat4x3 local = getLocalModelMatrix();
+		m_modelMatrix = glm::mat4(glm::vec4(local[0], 0.0f), glm::vec4(local[1], 0.0f), glm::vec4(local[2], 0.0f), glm::vec4(local[3], 1.0f));
+		onModelMatrixChanged();
 	}
 
 	void computeModelMatrix(const glm::mat4& parentGlobalModelMatrix)
 	{
-		m_modelMatrix = parentGlobalModelMatrix * getLocalModelMatrix();
-		m_isDirty = false;
+		m_modelMatrix = composeAffine(parentGlobalModelMatrix, getLocalModelMatrix());
+		onModelMatrixChanged();
 	}
 
 	void setLocalPosition(const glm::vec3& newPosition)
@@ -53,9 +84,27 @@ public:
 		m_isDirty = true;
 	}
 
+	//Euler angles in degrees, applied in the Y * X * Z order
 	void setLocalRotation(const glm::vec3& newRotation)
 	{
 		m_eulerRot = newRotation;
+		m_rot = glm::angleAxis(glm::radians(newRotation.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::angleAxis(glm::radians(newRotation.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+			glm::angleAxis(glm::radians(newRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		m_isDirty = true;
+	}
+
+	void setLocalRotation(const glm::quat& newRotation)
+	{
+		m_rot = glm::normalize(newRotation);
+
+		//Y * X * Z Euler angles of the rotation matrix (same decomposition as glm::extractEulerAngleYXZ)
+		const glm::mat3 rotation = glm::mat3_cast(m_rot);
+		const float yaw = std::atan2(rotation[2][0], rotation[2][2]);
+		const float pitch = std::atan2(-rotation[2][1], std::sqrt(rotation[0][1] * rotation[0][1] + rotation[1][1] * rotation[1][1]));
+		const float sinYaw = std::sin(yaw), cosYaw = std::cos(yaw);
+		const float roll = std::atan2(sinYaw * rotation[1][2] - cosYaw * rotation[1][0], cosYaw * rotation[0][0] - sinYaw * rotation[0][2]);
+		m_eulerRot = glm::degrees(glm::vec3(pitch, yaw, roll));
 		m_isDirty = true;
 	}
 
@@ -65,7 +114,7 @@ public:
 		m_isDirty = true;
 	}
 
-	const glm::vec3& getGlobalPosition() const
+	glm::vec3 getGlobalPosition() const
 	{
 		return m_modelMatrix[3];
 	}
@@ -80,6 +129,11 @@ public:
 		return m_eulerRot;
 	}
 
+	const glm::quat& getLocalOrientation() const
+	{
+		return m_rot;
+	}
+
 	const glm::vec3& getLocalScale() const
 	{
 		return m_scale;
@@ -90,6 +144,19 @@ public:
 		return m_modelMatrix;
 	}
 
+	//Inverse of the model matrix, only recomputed after the model matrix changed
+	const glm::mat4& getInverseModelMatrix() const
+	{
+		if (m_isInverseDirty)
+		{
+			const glm::mat3 inverseBasis = glm::inverse(glm::mat3(m_modelMatrix));
+			m_inverseModelMatrix = glm::mat4(inverseBasis);
+			m_inverseModelMatrix[3] = glm::vec4(-(inverseBasis * glm::vec3(m_modelMatrix[3])), 1.0f);
+			m_isInverseDirty = false;
+		}
+		return m_inverseModelMatrix;
+	}
+
 	glm::vec3 getRight() const
 	{
 		return m_modelMatrix[0];
@@ -111,15 +178,20 @@ public:
 		return -m_modelMatrix[2];
 	}
 
-	glm::vec3 getGlobalScale() const
+	const glm::vec3& getGlobalScale() const
 	{
-		return { glm::length(getRight()), glm::length(getUp()), glm::length(getBackward()) };
+		return m_globalScale;
 	}
 
 	bool isDirty() const
 	{
 		return m_isDirty;
 	}
+
+	std::uint32_t getVersion() const
+	{
+		return m_version;
+	}
 };
 
 struct Plane
@@ -383,36 +455,74 @@ Sphere generateSphereBV(const Model& model)
 	return Sphere((maxAABB + minAABB) * 0.5f, glm::length(minAABB - maxAABB));
 }
 
+class Entity;
+using EntityPool = ChunkedPool<Entity>;
+
+//Structure keeping pointers to entities (e.g. SpatialHash). It is told when a registered entity moves or is destroyed
+//so it never holds a dangling pointer.
+class EntityListener
+{
+public:
+	//The model matrix of the entity was recomputed
+	virtual void onEntityMoved(Entity& entity) = 0;
+	//The entity is being destroyed, the listener must forget it
+	virtual void onEntityDestroyed(Entity& entity) = 0;
+
+protected:
+	~EntityListener() = default;
+};
+
 class Entity
 {
 public:
-	//Scene graph
-	std::list<std::unique_ptr<Entity>> children;
+	//Scene graph. Children are owned by the entity pool, the parent releases them when it is destroyed.
+	std::vector<Entity*> children;
 	Entity* parent = nullptr;
+	PoolHandle handle; //invalid for entities that were not created by the pool (e.g. the root of the scene)
 
 	//Space information
 	Transform transform;
 
 	Model* pModel = nullptr;
-	std::unique_ptr<AABB> boundingVolume;
+	AABB boundingVolume; //model space bounds, copied from the model which computed them once when it was loaded
+
+	//Structure the entity is registered in, if any. An entity has at most one listener.
+	EntityListener* listener = nullptr;
+	std::uint32_t listenerIndex = 0; //owned by the listener, e.g. to find its record of the entity without a lookup
 
 
 	// constructor, expects a filepath to a 3D model.
-	Entity(Model& model) : pModel{ &model }
+	Entity(Model& model) : pModel{ &model }, boundingVolume{ model.boundsMin, model.boundsMax }
+	{
+	}
+
+	Entity(const Entity&) = delete;
+	Entity& operator=(const Entity&) = delete;
+
+	~Entity()
 	{
-		boundingVolume = std::make_unique<AABB>(generateAABB(model));
-		//boundingVolume = std::make_unique<Sphere>(generateSphereBV(model));
+		for (Entity* child : children)
+			pool().destroy(child->handle);
+		if (listener)
+			listener->onEntityDestroyed(*this);
+	}
+
+	//Every child entity of every scene graph is allocated from this pool
+	static EntityPool& pool()
+	{
+		static EntityPool entityPool;
+		return entityPool;
 	}
 
 	AABB getGlobalAABB()
 	{
 		//Get global scale thanks to our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(boundingVolume->center, 1.f) };
+		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(boundingVolume.center, 1.f) };
 
 		// Scaled orientation
-		const glm::vec3 right = transform.getRight() * boundingVolume->extents.x;
-		const glm::vec3 up = transform.getUp() * boundingVolume->extents.y;
-		const glm::vec3 forward = transform.getForward() * boundingVolume->extents.z;
+		const glm::vec3 right = transform.getRight() * boundingVolume.extents.x;
+		const glm::vec3 up = transform.getUp() * boundingVolume.extents.y;
+		const glm::vec3 forward = transform.getForward() * boundingVolume.extents.z;
 
 		const float newIi = std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, right)) +
 			std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, up)) +
@@ -430,11 +540,16 @@ public:
 	}
 
 	//Add child. Argument input is argument of any constructor that you create. By default you can use the default constructor and don't put argument input.
+	//Returns the new child, which stays at the same address for its whole lifetime.
 	template<typename... TArgs>
-	void addChild(TArgs&... args)
-	{
-		children.emplace_back(std::make_unique<Entity>(args...));
-		children.back()->parent = this;
+	Entity& addChild(TArgs&... args)
+	{
+		const PoolHandle childHandle = pool().create(args...);
+		Entity* child = pool().get(childHandle);
+		child->handle = childHandle;
+		child->parent = this;
+		children.push_back(child);
+		return *child;
 	}
 
 	//Update transform if it was changed
@@ -445,7 +560,7 @@ public:
 			return;
 		}
 			
-		for (auto&& child : children)
+		for (Entity* child : children)
 		{
 			child->updateSelfAndChild();
 		}
@@ -458,8 +573,10 @@ public:
 			transform.computeModelMatrix(parent->transform.getModelMatrix());
 		else
 			transform.computeModelMatrix();
+		if (listener)
+			listener->onEntityMoved(*this);
 
-		for (auto&& child : children)
+		for (Entity* child : children)
 		{
 			child->forceUpdateSelfAndChild();
 		}
@@ -468,7 +585,7 @@ public:
 
 	void drawSelfAndChild(const Frustum& frustum, Shader& ourShader, unsigned int& display, unsigned int& total)
 	{
-		if (boundingVolume->isOnFrustum(frustum, transform))
+		if (boundingVolume.isOnFrustum(frustum, transform))
 		{
 			ourShader.setMat4("model", transform.getModelMatrix());
 			pModel->Draw(ourShader);
@@ -476,7 +593,7 @@ public:
 		}
 		total++;
 
-		for (auto&& child : children)
+		for (Entity* child : children)
 		{
 			child->drawSelfAndChild(frustum, ourShader, display, total);
 		}
@@ -60,6 +60,33 @@ public:
     void Draw(Shader &shader) 
     {
         // bind appropriate textures
+        BindTextures(shader);
+        
+        // draw mesh
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+
+        // always good practice to set everything back to defaults once configured.
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // render instanceCount copies of the mesh in a single draw call; the per instance attributes
+    // must have been configured on the VAO beforehand (see SceneRenderer or the asteroids_instanced sample)
+    void DrawInstanced(Shader &shader, unsigned int instanceCount)
+    {
+        BindTextures(shader);
+
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0, instanceCount);
+        glBindVertexArray(0);
+
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // binds every texture of the mesh to its own unit and points the matching sampler uniform at it
+    void BindTextures(Shader &shader)
+    {
         unsigned int diffuseNr  = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr   = 1;
@@ -84,14 +111,6 @@ public:
             // and finally bind the texture
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
-        
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        // always good practice to set everything back to defaults once configured.
-        glActiveTexture(GL_TEXTURE0);
     }
 
 private:
@@ -17,6 +17,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <vector>
 using namespace std;
@@ -31,6 +32,8 @@ public:
     vector<Mesh>    meshes;
     string directory;
     bool gammaCorrection;
+    glm::vec3 boundsMin = glm::vec3(0.0f);   // model space bounds of every mesh, computed once when the model is loaded
+    glm::vec3 boundsMax = glm::vec3(0.0f);
 
     // constructor, expects a filepath to a 3D model.
     Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
@@ -63,6 +66,24 @@ private:
 
         // process ASSIMP's root node recursively
         processNode(scene->mRootNode, scene);
+        computeBounds();
+    }
+
+    // computes the model space bounds of all the vertices so users of the model (e.g. culling) never scan them again.
+    void computeBounds()
+    {
+        if (meshes.empty())
+            return;
+        boundsMin = glm::vec3(std::numeric_limits<float>::max());
+        boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+        for (const Mesh& mesh : meshes)
+        {
+            for (const Vertex& vertex : mesh.vertices)
+            {
+                boundsMin = glm::min(boundsMin, vertex.Position);
+                boundsMax = glm::max(boundsMax, vertex.Position);
+            }
+        }
     }
 
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
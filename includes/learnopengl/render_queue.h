@@ -0,0 +1,232 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+
+#include <algorithm> //std::min
+#include <cstdint> //std::uint64_t
+#include <map> //std::map
+#include <unordered_map> //std::unordered_map
+#include <vector> //std::vector
+
+//Number of GL state changes needed to execute a list of draws
+struct RenderStateChanges
+{
+	unsigned int programs = 0;
+	unsigned int materials = 0;
+	unsigned int vertexArrays = 0;
+	unsigned int draws = 0;
+};
+
+//Collects the draws of a frame, each one encoded as a 64 bit sort key plus a small payload, and executes them
+//sorted so that draws sharing a program, material and VAO follow each other. Redundant state changes are skipped.
+//
+//Opaque key   : layer(4) | translucent = 0 (1) | program(11) | material(16) | depth front to back(24) | unused(8)
+//Translucent  : layer(4) | translucent = 1 (1) | depth back to front(24) | program(11) | material(16) | unused(8)
+//
+//Translucent draws sort on depth first since blending is only correct back to front, opaque draws only use
+//depth to order draws sharing the same state front to back for early depth rejection.
+class RenderQueue
+{
+public:
+	//Start a new frame. The depth of every draw is bucketed linearly between zNear and zFar from the camera position.
+	void begin(const glm::vec3& cameraPosition, float zNear, float zFar)
+	{
+		m_cameraPosition = cameraPosition;
+		m_zNear = zNear;
+		m_invDepthRange = 1.0f / (zFar - zNear);
+		m_items.clear();
+		m_keys.clear();
+	}
+
+	void submit(Mesh& mesh, Shader& shader, const glm::mat4& model, unsigned int layer = 0, bool translucent = false)
+	{
+		const float distance = glm::length(glm::vec3(model[3]) - m_cameraPosition);
+		const float normalizedDepth = glm::clamp((distance - m_zNear) * m_invDepthRange, 0.0f, 1.0f);
+		std::uint64_t depth = static_cast<std::uint64_t>(normalizedDepth * float(DEPTH_MASK));
+		const std::uint64_t program = shader.ID & PROGRAM_MASK;
+		const std::uint32_t materialID = getMaterialID(mesh);
+		const std::uint64_t material = materialID & MATERIAL_MASK;
+
+		std::uint64_t key = std::uint64_t(layer & 0xF) << 60;
+		if (translucent)
+		{
+			depth = DEPTH_MASK - depth;
+			key |= std::uint64_t(1) << 59 | depth << 35 | program << 24 | material << 8;
+		}
+		else
+		{
+			key |= program << 48 | material << 32 | depth << 8;
+		}
+
+		m_keys.push_back({ key, static_cast<std::uint32_t>(m_items.size()) });
+		m_items.push_back({ &mesh, &shader, materialID, model });
+	}
+
+	//Sort the draws of the frame. Call before execute.
+	void sort()
+	{
+		radixSort(m_keys, m_scratch);
+	}
+
+	//Issue the draws in key order. The camera uniforms of every shader must have been set by the caller.
+	void execute()
+	{
+		unsigned int program = 0, VAO = 0;
+		std::uint32_t material = 0;
+		bool materialBound = false;
+		for (const SortKey& sortKey : m_keys)
+		{
+			const Item& item = m_items[sortKey.index];
+			if (item.shader->ID != program)
+			{
+				item.shader->use();
+				program = item.shader->ID;
+				materialBound = false; //sampler uniforms are program state
+			}
+
+			if (!materialBound || item.material != material)
+			{
+				item.mesh->BindTextures(*item.shader);
+				material = item.material;
+				materialBound = true;
+			}
+
+			if (item.mesh->VAO != VAO)
+			{
+				glBindVertexArray(item.mesh->VAO);
+				VAO = item.mesh->VAO;
+			}
+
+			item.shader->setMat4("model", item.model);
+			glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(item.mesh->indices.size()), GL_UNSIGNED_INT, 0);
+		}
+		glBindVertexArray(0);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	//State changes needed to execute the draws in submission order (what traversal order rendering costs)
+	RenderStateChanges countSubmissionOrderStateChanges() const
+	{
+		RenderStateChanges changes;
+		const Item* previous = nullptr;
+		for (const Item& item : m_items)
+		{
+			countStateChanges(previous, item, changes);
+			previous = &item;
+		}
+		return changes;
+	}
+
+	//State changes needed to execute the draws in sorted order
+	RenderStateChanges countSortedStateChanges() const
+	{
+		RenderStateChanges changes;
+		const Item* previous = nullptr;
+		for (const SortKey& sortKey : m_keys)
+		{
+			countStateChanges(previous, m_items[sortKey.index], changes);
+			previous = &m_items[sortKey.index];
+		}
+		return changes;
+	}
+
+	std::size_t size() const { return m_items.size(); }
+
+private:
+	static constexpr std::uint64_t DEPTH_MASK = (std::uint64_t(1) << 24) - 1;
+	static constexpr std::uint64_t PROGRAM_MASK = (std::uint64_t(1) << 11) - 1;
+	static constexpr std::uint64_t MATERIAL_MASK = (std::uint64_t(1) << 16) - 1;
+
+	struct SortKey
+	{
+		std::uint64_t key;
+		std::uint32_t index;
+	};
+
+	struct Item
+	{
+		Mesh* mesh;
+		Shader* shader;
+		std::uint32_t material; //resolved once at submit time
+		glm::mat4 model;
+	};
+
+	//Meshes binding the same textures share a material ID
+	std::uint32_t getMaterialID(const Mesh& mesh)
+	{
+		auto it = m_meshMaterials.find(&mesh);
+		if (it != m_meshMaterials.end())
+			return it->second;
+
+		std::vector<unsigned int> textureIDs;
+		for (const Texture& texture : mesh.textures)
+			textureIDs.push_back(texture.id);
+		auto material = m_materials.emplace(textureIDs, static_cast<std::uint32_t>(m_materials.size())).first;
+		m_meshMaterials.emplace(&mesh, material->second);
+		return material->second;
+	}
+
+	void countStateChanges(const Item* previous, const Item& item, RenderStateChanges& changes) const
+	{
+		const bool programChanged = !previous || previous->shader->ID != item.shader->ID;
+		changes.programs += programChanged;
+		changes.materials += programChanged || previous->material != item.material;
+		changes.vertexArrays += !previous || previous->mesh->VAO != item.mesh->VAO;
+		changes.draws++;
+	}
+
+	//LSD radix sort on 8 bit digits. Digits where every key is equal are skipped, so unused key bits cost nothing.
+	static void radixSort(std::vector<SortKey>& keys, std::vector<SortKey>& scratch)
+	{
+		const std::size_t count = keys.size();
+		if (count < 2)
+			return;
+
+		std::size_t histograms[8][256] = {};
+		for (const SortKey& sortKey : keys)
+		{
+			for (unsigned int digit = 0; digit < 8; ++digit)
+				histograms[digit][(sortKey.key >> (digit * 8)) & 0xFF]++;
+		}
+
+		scratch.resize(count);
+		std::vector<SortKey>* source = &keys;
+		std::vector<SortKey>* destination = &scratch;
+		for (unsigned int digit = 0; digit < 8; ++digit)
+		{
+			std::size_t* histogram = histograms[digit];
+			if (histogram[(keys[0].key >> (digit * 8)) & 0xFF] == count)
+				continue;
+
+			std::size_t offset = 0;
+			for (unsigned int bucket = 0; bucket < 256; ++bucket)
+			{
+				const std::size_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			for (const SortKey& sortKey : *source)
+				(*destination)[histogram[(sortKey.key >> (digit * 8)) & 0xFF]++] = sortKey;
+			std::swap(source, destination);
+		}
+
+		if (source != &keys)
+			keys.swap(scratch);
+	}
+
+	std::vector<Item> m_items;
+	std::vector<SortKey> m_keys;
+	std::vector<SortKey> m_scratch;
+	std::unordered_map<const Mesh*, std::uint32_t> m_meshMaterials;
+	std::map<std::vector<unsigned int>, std::uint32_t> m_materials;
+
+	glm::vec3 m_cameraPosition = glm::vec3(0.0f);
+	float m_zNear = 0.1f;
+	float m_invDepthRange = 1.0f;
+};
+#endif
@@ -0,0 +1,154 @@
+#ifndef SCENE_RENDERER_H
+#define SCENE_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/entity.h>
+
+#include <unordered_map> //std::unordered_map
+#include <unordered_set> //std::unordered_set
+#include <vector> //std::vector
+
+//Collects the visible entities of a scene graph, groups them by model and draws every mesh of a group
+//with a single glDrawElementsInstanced call. Each mesh carries its own material (textures), so a group
+//per model results in one draw per (model, mesh, material).
+//The world matrices of all instances are streamed into one instance buffer every frame and read with the
+//same layout as the asteroids_instanced sample: a mat4 spread over the attribute locations 3, 4, 5 and 6.
+//Note that these locations override the tangent, bitangent and bone attributes of the mesh VAO, so the
+//instanced shader must only read the position, normal and texture coordinates of the mesh.
+class SceneRenderer
+{
+public:
+	SceneRenderer()
+	{
+		glGenBuffers(1, &m_instanceBuffer);
+	}
+
+	~SceneRenderer()
+	{
+		glDeleteBuffers(1, &m_instanceBuffer);
+	}
+
+	SceneRenderer(const SceneRenderer&) = delete;
+	SceneRenderer& operator=(const SceneRenderer&) = delete;
+
+	//Frustum cull the scene graph and sort the visible entities in their batch
+	void collect(Entity& root, const Frustum& frustum)
+	{
+		for (Batch& batch : m_batches)
+			batch.matrices.clear();
+		m_display = 0;
+		m_total = 0;
+
+		collectSelfAndChild(root, frustum);
+	}
+
+	//Upload the instance matrices and issue one instanced draw per mesh of every non empty batch
+	void draw(Shader& shader)
+	{
+		m_drawCalls = 0;
+
+		std::size_t instanceCount = 0;
+		for (Batch& batch : m_batches)
+		{
+			batch.firstInstance = instanceCount;
+			instanceCount += batch.matrices.size();
+		}
+		if (instanceCount == 0)
+			return;
+
+		glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+		//orphan the previous storage so the driver doesn't have to wait for last frame's draws to finish
+		glBufferData(GL_ARRAY_BUFFER, instanceCount * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+		for (Batch& batch : m_batches)
+		{
+			if (!batch.matrices.empty())
+				glBufferSubData(GL_ARRAY_BUFFER, batch.firstInstance * sizeof(glm::mat4), batch.matrices.size() * sizeof(glm::mat4), batch.matrices.data());
+		}
+
+		for (Batch& batch : m_batches)
+		{
+			if (batch.matrices.empty())
+				continue;
+
+			const GLsizeiptr offset = batch.firstInstance * sizeof(glm::mat4);
+			for (Mesh& mesh : batch.pModel->meshes)
+			{
+				setInstanceAttributes(mesh.VAO, offset);
+				mesh.DrawInstanced(shader, static_cast<unsigned int>(batch.matrices.size()));
+				++m_drawCalls;
+			}
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	unsigned int getDisplayCount() const { return m_display; }
+	unsigned int getTotalCount() const { return m_total; }
+	unsigned int getDrawCallCount() const { return m_drawCalls; }
+
+private:
+	struct Batch
+	{
+		Model* pModel = nullptr;
+		std::vector<glm::mat4> matrices;
+		std::size_t firstInstance = 0;
+	};
+
+	void collectSelfAndChild(Entity& entity, const Frustum& frustum)
+	{
+		if (entity.boundingVolume.isOnFrustum(frustum, entity.transform))
+		{
+			getBatch(entity.pModel).matrices.push_back(entity.transform.getModelMatrix());
+			m_display++;
+		}
+		m_total++;
+
+		for (Entity* child : entity.children)
+		{
+			collectSelfAndChild(*child, frustum);
+		}
+	}
+
+	Batch& getBatch(Model* pModel)
+	{
+		auto it = m_batchIndices.find(pModel);
+		if (it != m_batchIndices.end())
+			return m_batches[it->second];
+
+		m_batchIndices.emplace(pModel, m_batches.size());
+		m_batches.emplace_back();
+		m_batches.back().pModel = pModel;
+		return m_batches.back();
+	}
+
+	//Point the instance matrix attributes of the VAO at the batch's range of the instance buffer
+	void setInstanceAttributes(unsigned int VAO, GLsizeiptr offset)
+	{
+		glBindVertexArray(VAO);
+		for (unsigned int i = 0; i < 4; ++i)
+		{
+			glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(offset + i * sizeof(glm::vec4)));
+		}
+
+		if (m_instancedVAOs.insert(VAO).second)
+		{
+			for (unsigned int i = 0; i < 4; ++i)
+			{
+				glEnableVertexAttribArray(3 + i);
+				glVertexAttribDivisor(3 + i, 1);
+			}
+		}
+		glBindVertexArray(0);
+	}
+
+	std::vector<Batch> m_batches;
+	std::unordered_map<Model*, std::size_t> m_batchIndices;
+	std::unordered_set<unsigned int> m_instancedVAOs;
+	unsigned int m_instanceBuffer = 0;
+
+	unsigned int m_display = 0;
+	unsigned int m_total = 0;
+	unsigned int m_drawCalls = 0;
+};
+#endif
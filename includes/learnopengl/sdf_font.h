@@ -0,0 +1,407 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <learnopengl/thread_pool.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+/*A glyph of an SdfFont, in pixels of the font's base size (multiply by size / GetBaseSize() to draw at another size)*/
+struct SdfGlyph
+{
+	glm::vec2 size;    // size of the glyph's quad, the distance field's spread included
+	glm::vec2 bearing; // offset from the pen position on the baseline to the top left of the quad, y up
+	float advance;     // horizontal offset to the next pen position
+	glm::vec4 uvRect;  // region of the quad in the atlas: <vec2 offset, vec2 size>, top row first
+};
+
+/*A font rasterized into a single channel signed distance field atlas.
+Every texel stores the distance to the closest glyph outline, 0.5 on the outline and larger inside, scaled so
+that GetSpread() texels map to 0.5. Unlike a coverage bitmap the field stays sharp when it's magnified, so one
+atlas draws any size: the shader thresholds the sampled distance at 0.5 and antialiases over a screen pixel.
+Generating the field is slow, so it runs on a ThreadPool (each worker rasterizes its own glyphs with its own
+FreeType face) and LoadOrGenerate caches the result in a file; afterwards loading a font is a
+single file read.*/
+class SdfFont
+{
+public:
+	/*pixel size glyphs are stored at in the atlas*/
+	static const int BASE_SIZE = 48;
+	/*distance in atlas texels covered on either side of the outline*/
+	static const int SPREAD = 6;
+	/*glyphs are rasterized this many times larger than BASE_SIZE and the distances measured at that resolution*/
+	static const int UPSCALE = 8;
+
+	typedef std::vector<std::pair<char32_t, char32_t>> Ranges;
+
+	/*Generate the atlas of the characters in ranges (<first, last> code points) from the font file at fontPath*/
+	static SdfFont Generate(const std::string& fontPath, const Ranges& ranges, ThreadPool& threadPool)
+	{
+		SdfFont font;
+		std::vector<unsigned char> fontData = ReadFile(fontPath);
+		if (fontData.empty())
+		{
+			std::cout << "ERROR::SDF_FONT::FAILED_TO_READ " << fontPath << std::endl;
+			return font;
+		}
+		font.m_Key = ComputeKey(fontData, ranges);
+
+		FT_Library library;
+		FT_Face face;
+		if (FT_Init_FreeType(&library) || FT_New_Memory_Face(library, fontData.data(), static_cast<FT_Long>(fontData.size()), 0, &face))
+		{
+			std::cout << "ERROR::SDF_FONT::FAILED_TO_LOAD_FONT " << fontPath << std::endl;
+			return font;
+		}
+		FT_Set_Pixel_Sizes(face, 0, BASE_SIZE);
+		font.m_Ascender = face->size->metrics.ascender / 64.0f;
+		font.m_LineHeight = face->size->metrics.height / 64.0f;
+		// only keep characters the font has, the others would all render as the same box
+		std::vector<char32_t> codePoints;
+		for (const auto& range : ranges)
+			for (char32_t c = range.first; c <= range.second; c++)
+				if (FT_Get_Char_Index(face, c) != 0)
+					codePoints.push_back(c);
+		FT_Done_Face(face);
+		FT_Done_FreeType(library);
+
+		// FreeType objects can't be shared between threads, every worker opens the font once
+		std::vector<RasterizedGlyph> glyphs(codePoints.size());
+		std::vector<FT_Library> libraries(threadPool.GetWorkerCount(), nullptr);
+		std::vector<FT_Face> faces(threadPool.GetWorkerCount(), nullptr);
+		threadPool.ParallelFor(codePoints.size(), 4, [&](std::size_t begin, std::size_t end, unsigned int workerIndex)
+		{
+			if (!libraries[workerIndex])
+			{
+				FT_Init_FreeType(&libraries[workerIndex]);
+				FT_New_Memory_Face(libraries[workerIndex], fontData.data(), static_cast<FT_Long>(fontData.size()), 0, &faces[workerIndex]);
+				FT_Set_Pixel_Sizes(faces[workerIndex], 0, BASE_SIZE * UPSCALE);
+			}
+			for (std::size_t i = begin; i < end; i++)
+				RasterizeGlyph(faces[workerIndex], codePoints[i], glyphs[i]);
+		});
+		for (unsigned int i = 0; i < libraries.size(); i++)
+		{
+			if (faces[i])
+				FT_Done_Face(faces[i]);
+			if (libraries[i])
+				FT_Done_FreeType(libraries[i]);
+		}
+
+		font.Pack(codePoints, glyphs);
+		return font;
+	}
+
+	/*Load the atlas cached at cachePath if it was generated from the same font file and ranges, otherwise
+	generate it and save it there*/
+	static SdfFont LoadOrGenerate(const std::string& cachePath, const std::string& fontPath, const Ranges& ranges)
+	{
+		SdfFont font;
+		if (font.Load(cachePath) && font.m_Key == ComputeKey(ReadFile(fontPath), ranges))
+			return font;
+
+		ThreadPool threadPool;
+		font = Generate(fontPath, ranges, threadPool);
+		if (!font.m_Glyphs.empty() && !font.Save(cachePath))
+			std::cout << "ERROR::SDF_FONT::FAILED_TO_WRITE " << cachePath << std::endl;
+		return font;
+	}
+
+	bool Save(const std::string& path) const
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		const Header header = { FILE_MAGIC, FILE_VERSION, BASE_SIZE, SPREAD, m_Width, m_Height, static_cast<std::uint32_t>(m_Glyphs.size()), m_Ascender, m_LineHeight, m_Key };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for (const auto& glyph : m_Glyphs)
+		{
+			const std::uint32_t codePoint = glyph.first;
+			file.write(reinterpret_cast<const char*>(&codePoint), sizeof(codePoint));
+			file.write(reinterpret_cast<const char*>(&glyph.second), sizeof(SdfGlyph));
+		}
+		file.write(reinterpret_cast<const char*>(m_Pixels.data()), m_Pixels.size());
+		return static_cast<bool>(file);
+	}
+
+	bool Load(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		Header header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != FILE_MAGIC || header.version != FILE_VERSION ||
+			header.baseSize != BASE_SIZE || header.spread != SPREAD)
+			return false;
+
+		std::unordered_map<char32_t, SdfGlyph> glyphs;
+		for (std::uint32_t i = 0; i < header.glyphCount; i++)
+		{
+			std::uint32_t codePoint;
+			SdfGlyph glyph;
+			if (!file.read(reinterpret_cast<char*>(&codePoint), sizeof(codePoint)) || !file.read(reinterpret_cast<char*>(&glyph), sizeof(glyph)))
+				return false;
+			glyphs[codePoint] = glyph;
+		}
+		std::vector<unsigned char> pixels(static_cast<std::size_t>(header.width) * header.height);
+		if (!file.read(reinterpret_cast<char*>(pixels.data()), pixels.size()))
+			return false;
+
+		m_Width = header.width;
+		m_Height = header.height;
+		m_Ascender = header.ascender;
+		m_LineHeight = header.lineHeight;
+		m_Key = header.key;
+		m_Glyphs.swap(glyphs);
+		m_Pixels.swap(pixels);
+		return true;
+	}
+
+	/*GL_R8 texture of the atlas, linearly filtered*/
+	unsigned int CreateTexture() const
+	{
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_Width, m_Height, 0, GL_RED, GL_UNSIGNED_BYTE, m_Pixels.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+
+	/*nullptr if the character isn't in the atlas*/
+	const SdfGlyph* GetGlyph(char32_t codePoint) const
+	{
+		auto glyph = m_Glyphs.find(codePoint);
+		return glyph != m_Glyphs.end() ? &glyph->second : nullptr;
+	}
+
+	const std::unordered_map<char32_t, SdfGlyph>& GetGlyphs() const { return m_Glyphs; }
+	int GetBaseSize() const { return BASE_SIZE; }
+	float GetSpread() const { return static_cast<float>(SPREAD); }
+	float GetAscender() const { return m_Ascender; }
+	float GetLineHeight() const { return m_LineHeight; }
+	std::uint32_t GetWidth() const { return m_Width; }
+	std::uint32_t GetHeight() const { return m_Height; }
+
+private:
+	static const std::uint32_t FILE_MAGIC = 0x31464453; // "SDF1"
+	static const std::uint32_t FILE_VERSION = 1;
+	/*texels left empty between glyphs so filtering never reads a neighbour*/
+	static const int PADDING = 1;
+
+	struct Header
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::int32_t baseSize;
+		std::int32_t spread;
+		std::uint32_t width;
+		std::uint32_t height;
+		std::uint32_t glyphCount;
+		float ascender;
+		float lineHeight;
+		std::uint64_t key;
+	};
+
+	/*the distance field of one glyph before it's packed*/
+	struct RasterizedGlyph
+	{
+		SdfGlyph metrics = SdfGlyph();
+		int width = 0, height = 0;
+		std::vector<unsigned char> field;
+	};
+
+	static std::vector<unsigned char> ReadFile(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	/*FNV-1a of everything the atlas is generated from*/
+	static std::uint64_t ComputeKey(const std::vector<unsigned char>& fontData, const Ranges& ranges)
+	{
+		std::uint64_t key = 14695981039346656037ull;
+		auto hash = [&key](const void* data, std::size_t size)
+		{
+			for (std::size_t i = 0; i < size; i++)
+				key = (key ^ static_cast<const unsigned char*>(data)[i]) * 1099511628211ull;
+		};
+		hash(fontData.data(), fontData.size());
+		for (const auto& range : ranges)
+		{
+			const std::uint32_t bounds[2] = { static_cast<std::uint32_t>(range.first), static_cast<std::uint32_t>(range.second) };
+			hash(bounds, sizeof(bounds));
+		}
+		return key;
+	}
+
+	/*Squared distance transform of a row or column (Felzenszwalb and Huttenlocher): f holds 0 on the feature
+	texels and a large value elsewhere, on return it holds the squared distance to the closest feature.
+	v and z are scratch memory of n and n + 1 elements.*/
+	static void DistanceTransform(float* f, int n, int stride, std::vector<float>& d, std::vector<int>& v, std::vector<float>& z)
+	{
+		const float INF = 1e20f;
+		int k = 0;
+		v[0] = 0;
+		z[0] = -INF;
+		z[1] = INF;
+		for (int q = 1; q < n; q++)
+		{
+			float s = ((f[q * stride] + q * q) - (f[v[k] * stride] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+			while (s <= z[k])
+			{
+				k--;
+				s = ((f[q * stride] + q * q) - (f[v[k] * stride] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+			}
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = INF;
+		}
+		k = 0;
+		for (int q = 0; q < n; q++)
+		{
+			while (z[k + 1] < q)
+				k++;
+			d[q] = (q - v[k]) * (q - v[k]) + f[v[k] * stride];
+		}
+		for (int q = 0; q < n; q++)
+			f[q * stride] = d[q];
+	}
+
+	/*squared distance of every texel of a width x height grid to the closest texel where inside matches feature*/
+	static std::vector<float> DistanceField(const std::vector<unsigned char>& inside, int width, int height, bool feature)
+	{
+		std::vector<float> f(inside.size());
+		for (std::size_t i = 0; i < inside.size(); i++)
+			f[i] = (inside[i] != 0) == feature ? 0.0f : 1e20f;
+		const int n = std::max(width, height);
+		std::vector<float> d(n);
+		std::vector<int> v(n);
+		std::vector<float> z(n + 1);
+		for (int x = 0; x < width; x++)
+			DistanceTransform(&f[x], height, width, d, v, z);
+		for (int y = 0; y < height; y++)
+			DistanceTransform(&f[static_cast<std::size_t>(y) * width], width, 1, d, v, z);
+		return f;
+	}
+
+	/*renders codePoint at BASE_SIZE * UPSCALE pixels and downsamples its signed distance to BASE_SIZE*/
+	static void RasterizeGlyph(FT_Face face, char32_t codePoint, RasterizedGlyph& glyph)
+	{
+		if (FT_Load_Char(face, codePoint, FT_LOAD_RENDER))
+		{
+			std::cout << "ERROR::SDF_FONT::FAILED_TO_LOAD_GLYPH " << static_cast<std::uint32_t>(codePoint) << std::endl;
+			return;
+		}
+		const FT_Bitmap& bitmap = face->glyph->bitmap;
+		glyph.metrics.advance = face->glyph->advance.x / 64.0f / UPSCALE;
+		if (bitmap.width == 0 || bitmap.rows == 0)
+		{
+			// nothing to draw (a space), only the advance matters
+			glyph.metrics.size = glm::vec2(0.0f);
+			glyph.metrics.bearing = glm::vec2(0.0f);
+			glyph.metrics.uvRect = glm::vec4(0.0f);
+			return;
+		}
+
+		// pad the high resolution bitmap by the spread, rounded up so it's a whole number of output texels
+		const int border = SPREAD * UPSCALE;
+		glyph.width = (static_cast<int>(bitmap.width) + 2 * border + UPSCALE - 1) / UPSCALE;
+		glyph.height = (static_cast<int>(bitmap.rows) + 2 * border + UPSCALE - 1) / UPSCALE;
+		const int width = glyph.width * UPSCALE, height = glyph.height * UPSCALE;
+		std::vector<unsigned char> inside(static_cast<std::size_t>(width) * height, 0);
+		for (unsigned int y = 0; y < bitmap.rows; y++)
+			for (unsigned int x = 0; x < bitmap.width; x++)
+				inside[static_cast<std::size_t>(y + border) * width + x + border] = bitmap.buffer[y * bitmap.pitch + x] >= 128;
+
+		// distance from outside texels to the glyph and from inside texels to the background;
+		// the outline lies half a texel from the centers on either side of it
+		const std::vector<float> toInside = DistanceField(inside, width, height, true);
+		const std::vector<float> toOutside = DistanceField(inside, width, height, false);
+		glyph.field.resize(static_cast<std::size_t>(glyph.width) * glyph.height);
+		for (int y = 0; y < glyph.height; y++)
+		{
+			for (int x = 0; x < glyph.width; x++)
+			{
+				const std::size_t sample = static_cast<std::size_t>(y * UPSCALE + UPSCALE / 2) * width + x * UPSCALE + UPSCALE / 2;
+				const float distance = inside[sample] ? std::sqrt(toOutside[sample]) - 0.5f : 0.5f - std::sqrt(toInside[sample]);
+				const float value = 0.5f + distance / UPSCALE / (2.0f * SPREAD);
+				glyph.field[static_cast<std::size_t>(y) * glyph.width + x] = static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+			}
+		}
+		glyph.metrics.size = glm::vec2(glyph.width, glyph.height);
+		glyph.metrics.bearing = glm::vec2(face->glyph->bitmap_left - border, face->glyph->bitmap_top + border) / static_cast<float>(UPSCALE);
+	}
+
+	/*packs the glyphs into rows (shelves), tallest first, in the narrowest power of two atlas that isn't much taller than it's wide*/
+	void Pack(const std::vector<char32_t>& codePoints, std::vector<RasterizedGlyph>& glyphs)
+	{
+		std::vector<std::size_t> order(glyphs.size());
+		std::size_t area = 0;
+		for (std::size_t i = 0; i < glyphs.size(); i++)
+		{
+			order[i] = i;
+			area += static_cast<std::size_t>(glyphs[i].width + PADDING) * (glyphs[i].height + PADDING);
+		}
+		std::sort(order.begin(), order.end(), [&glyphs](std::size_t a, std::size_t b) { return glyphs[a].height > glyphs[b].height; });
+
+		m_Width = 64;
+		while (static_cast<std::size_t>(m_Width) * m_Width < area)
+			m_Width *= 2;
+		std::vector<glm::ivec2> positions(glyphs.size());
+		int x = PADDING, y = PADDING, shelfHeight = 0;
+		for (std::size_t i : order)
+		{
+			if (x + glyphs[i].width + PADDING > static_cast<int>(m_Width))
+			{
+				x = PADDING;
+				y += shelfHeight + PADDING;
+				shelfHeight = 0;
+			}
+			positions[i] = glm::ivec2(x, y);
+			x += glyphs[i].width + PADDING;
+			shelfHeight = std::max(shelfHeight, glyphs[i].height);
+		}
+		m_Height = 64;
+		while (static_cast<int>(m_Height) < y + shelfHeight + PADDING)
+			m_Height *= 2;
+
+		m_Pixels.assign(static_cast<std::size_t>(m_Width) * m_Height, 0);
+		m_Glyphs.clear();
+		for (std::size_t i = 0; i < glyphs.size(); i++)
+		{
+			RasterizedGlyph& glyph = glyphs[i];
+			for (int row = 0; row < glyph.height; row++)
+				std::copy(&glyph.field[static_cast<std::size_t>(row) * glyph.width], &glyph.field[static_cast<std::size_t>(row) * glyph.width] + glyph.width,
+					&m_Pixels[static_cast<std::size_t>(positions[i].y + row) * m_Width + positions[i].x]);
+			if (glyph.width > 0)
+				glyph.metrics.uvRect = glm::vec4(glm::vec2(positions[i]), glyph.width, glyph.height) / glm::vec4(m_Width, m_Height, m_Width, m_Height);
+			m_Glyphs[codePoints[i]] = glyph.metrics;
+		}
+	}
+
+	std::unordered_map<char32_t, SdfGlyph> m_Glyphs;
+	std::vector<unsigned char> m_Pixels;
+	std::uint32_t m_Width = 0;
+	std::uint32_t m_Height = 0;
+	float m_Ascender = 0.0f;
+	float m_LineHeight = 0.0f;
+	std::uint64_t m_Key = 0;
+};
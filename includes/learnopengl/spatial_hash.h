@@ -0,0 +1,382 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/entity.h>
+
+#include <algorithm> //std::min, std::max
+#include <cmath> //std::floor
+#include <cstdint> //std::uint32_t
+#include <limits> //std::numeric_limits
+#include <vector> //std::vector
+
+//Uniform grid over the world space bounds of entities. Cells are addressed by their integer coordinates, hashed
+//into a fixed number of buckets so the world doesn't need to be bounded. An entity is registered in every cell
+//its world AABB overlaps.
+//Entity pointers are stable (see EntityPool) and are used as handles: queries write them into a buffer provided
+//by the caller and never allocate. They return the number of entities found, which can be larger than the
+//capacity of the buffer; only the first capacity entities are written in that case.
+//The hash is the listener of the entities it holds: they queue themselves when they move and unregister when
+//they are destroyed.
+class SpatialHash : public EntityListener
+{
+public:
+	//bucketCount is rounded up to a power of two
+	SpatialHash(float cellSize, std::size_t bucketCount = 4096)
+		: m_cellSize{ cellSize }, m_invCellSize{ 1.0f / cellSize }
+	{
+		std::size_t count = 1;
+		while (count < bucketCount)
+			count <<= 1;
+		m_buckets.resize(count);
+		m_bucketMask = static_cast<std::uint32_t>(count - 1);
+	}
+
+	SpatialHash(const SpatialHash&) = delete;
+	SpatialHash& operator=(const SpatialHash&) = delete;
+
+	~SpatialHash()
+	{
+		for (Proxy& proxy : m_proxies)
+			proxy.entity->listener = nullptr;
+	}
+
+	//An entity can only be registered in one spatial hash at a time; entities registered elsewhere are ignored
+	void insert(Entity& entity)
+	{
+		if (entity.listener)
+			return;
+
+		const std::uint32_t proxyIndex = static_cast<std::uint32_t>(m_proxies.size());
+		m_proxies.emplace_back();
+		Proxy& proxy = m_proxies.back();
+		proxy.entity = &entity;
+		refreshBounds(proxy);
+		addToCells(proxyIndex, proxy.cellMin, proxy.cellMax);
+		entity.listener = this;
+		entity.listenerIndex = proxyIndex;
+	}
+
+	//Insert the entity and all its descendants
+	void insertSelfAndChild(Entity& entity)
+	{
+		insert(entity);
+		for (Entity* child : entity.children)
+			insertSelfAndChild(*child);
+	}
+
+	void remove(Entity& entity)
+	{
+		if (entity.listener != this)
+			return;
+
+		const std::uint32_t proxyIndex = entity.listenerIndex;
+		removeFromCells(proxyIndex, m_proxies[proxyIndex].cellMin, m_proxies[proxyIndex].cellMax);
+		entity.listener = nullptr;
+
+		//Keep the proxies packed by moving the last one into the freed slot
+		const std::uint32_t lastIndex = static_cast<std::uint32_t>(m_proxies.size() - 1);
+		if (proxyIndex != lastIndex)
+		{
+			Proxy& last = m_proxies[lastIndex];
+			replaceInCells(lastIndex, proxyIndex, last.cellMin, last.cellMax);
+			last.entity->listenerIndex = proxyIndex;
+			m_proxies[proxyIndex] = last;
+			//The queued entry of the moved proxy still holds its old index, queue it again under the new one
+			if (last.queued)
+				m_movedProxies.push_back(proxyIndex);
+		}
+		m_proxies.pop_back();
+	}
+
+	void onEntityMoved(Entity& entity) override
+	{
+		Proxy& proxy = m_proxies[entity.listenerIndex];
+		if (!proxy.queued)
+		{
+			proxy.queued = true;
+			m_movedProxies.push_back(entity.listenerIndex);
+		}
+	}
+
+	void onEntityDestroyed(Entity& entity) override
+	{
+		remove(entity);
+	}
+
+	//Re-bucket the entities whose transform was recomputed since the last update. Call after updateSelfAndChild.
+	//Only the queued entities are visited and only the ones that moved to other cells touch the buckets.
+	void update()
+	{
+		m_movedCount = 0;
+		for (std::uint32_t proxyIndex : m_movedProxies)
+		{
+			//Entries of removed proxies, or queued twice after a remove, are skipped
+			if (proxyIndex >= m_proxies.size() || !m_proxies[proxyIndex].queued)
+				continue;
+			Proxy& proxy = m_proxies[proxyIndex];
+			proxy.queued = false;
+
+			const glm::ivec3 oldCellMin = proxy.cellMin, oldCellMax = proxy.cellMax;
+			refreshBounds(proxy);
+			if (oldCellMin != proxy.cellMin || oldCellMax != proxy.cellMax)
+			{
+				removeFromCells(proxyIndex, oldCellMin, oldCellMax);
+				addToCells(proxyIndex, proxy.cellMin, proxy.cellMax);
+				++m_movedCount;
+			}
+		}
+		m_movedProxies.clear();
+	}
+
+	std::size_t queryBox(const glm::vec3& min, const glm::vec3& max, Entity** result, std::size_t capacity)
+	{
+		const std::uint32_t stamp = nextQueryStamp();
+		std::size_t count = 0;
+		const glm::ivec3 cellMin = toCell(min), cellMax = toCell(max);
+		for (int z = cellMin.z; z <= cellMax.z; ++z)
+			for (int y = cellMin.y; y <= cellMax.y; ++y)
+				for (int x = cellMin.x; x <= cellMax.x; ++x)
+				{
+					const glm::ivec3 cell{ x, y, z };
+					for (const CellEntry& entry : m_buckets[bucketOf(cell)])
+					{
+						if (entry.cell != cell)
+							continue;
+						Proxy& proxy = m_proxies[entry.proxyIndex];
+						if (proxy.stamp == stamp)
+							continue;
+						proxy.stamp = stamp;
+
+						if (glm::all(glm::lessThanEqual(proxy.min, max)) && glm::all(glm::lessThanEqual(min, proxy.max)))
+							emit(proxy.entity, result, capacity, count);
+					}
+				}
+		return count;
+	}
+
+	std::size_t querySphere(const glm::vec3& center, float radius, Entity** result, std::size_t capacity)
+	{
+		const std::uint32_t stamp = nextQueryStamp();
+		const float radiusSquared = radius * radius;
+		std::size_t count = 0;
+		const glm::ivec3 cellMin = toCell(center - radius), cellMax = toCell(center + radius);
+		for (int z = cellMin.z; z <= cellMax.z; ++z)
+			for (int y = cellMin.y; y <= cellMax.y; ++y)
+				for (int x = cellMin.x; x <= cellMax.x; ++x)
+				{
+					const glm::ivec3 cell{ x, y, z };
+					for (const CellEntry& entry : m_buckets[bucketOf(cell)])
+					{
+						if (entry.cell != cell)
+							continue;
+						Proxy& proxy = m_proxies[entry.proxyIndex];
+						if (proxy.stamp == stamp)
+							continue;
+						proxy.stamp = stamp;
+
+						const glm::vec3 closest = glm::clamp(center, proxy.min, proxy.max);
+						const glm::vec3 difference = closest - center;
+						if (glm::dot(difference, difference) <= radiusSquared)
+							emit(proxy.entity, result, capacity, count);
+					}
+				}
+		return count;
+	}
+
+	//Entities whose world AABB is crossed by the segment [origin, origin + direction * maxDistance].
+	//Cells are walked in ray order (Amanatides & Woo), so the first entities written are the closest cells' ones.
+	std::size_t queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Entity** result, std::size_t capacity)
+	{
+		const std::uint32_t stamp = nextQueryStamp();
+		std::size_t count = 0;
+
+		const glm::vec3 invDirection = 1.0f / direction;
+		glm::ivec3 cell = toCell(origin);
+		const glm::ivec3 lastCell = toCell(origin + direction * maxDistance);
+		const glm::ivec3 step{ direction.x < 0.0f ? -1 : 1, direction.y < 0.0f ? -1 : 1, direction.z < 0.0f ? -1 : 1 };
+
+		//distance along the ray to the next cell boundary on each axis, and between two boundaries
+		glm::vec3 tMax, tDelta;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (direction[axis] == 0.0f)
+			{
+				tMax[axis] = std::numeric_limits<float>::max();
+				tDelta[axis] = std::numeric_limits<float>::max();
+				continue;
+			}
+			const float boundary = (cell[axis] + (step[axis] > 0 ? 1 : 0)) * m_cellSize;
+			tMax[axis] = (boundary - origin[axis]) * invDirection[axis];
+			tDelta[axis] = m_cellSize * std::abs(invDirection[axis]);
+		}
+
+		while (true)
+		{
+			for (const CellEntry& entry : m_buckets[bucketOf(cell)])
+			{
+				if (entry.cell != cell)
+					continue;
+				Proxy& proxy = m_proxies[entry.proxyIndex];
+				if (proxy.stamp == stamp)
+					continue;
+				proxy.stamp = stamp;
+
+				if (intersectRay(origin, direction, invDirection, maxDistance, proxy.min, proxy.max))
+					emit(proxy.entity, result, capacity, count);
+			}
+
+			if (cell == lastCell)
+				break;
+
+			int axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+			if (tMax[axis] > maxDistance)
+				break;
+			cell[axis] += step[axis];
+			tMax[axis] += tDelta[axis];
+		}
+		return count;
+	}
+
+	std::size_t size() const { return m_proxies.size(); }
+	//Number of entities that changed cells during the last update
+	std::size_t movedCount() const { return m_movedCount; }
+
+private:
+	struct Proxy
+	{
+		Entity* entity = nullptr;
+		glm::vec3 min{ 0.f }, max{ 0.f };
+		glm::ivec3 cellMin{ 0 }, cellMax{ 0 };
+		std::uint32_t stamp = 0;
+		bool queued = false; //in m_movedProxies
+	};
+
+	//Distant cells share buckets, keeping the cell in the entry rejects them without touching the proxy
+	struct CellEntry
+	{
+		glm::ivec3 cell;
+		std::uint32_t proxyIndex;
+	};
+
+	glm::ivec3 toCell(const glm::vec3& position) const
+	{
+		return glm::ivec3(glm::floor(position * m_invCellSize));
+	}
+
+	std::uint32_t bucketOf(const glm::ivec3& cell) const
+	{
+		const std::uint32_t hash = (static_cast<std::uint32_t>(cell.x) * 73856093u) ^
+			(static_cast<std::uint32_t>(cell.y) * 19349663u) ^
+			(static_cast<std::uint32_t>(cell.z) * 83492791u);
+		return hash & m_bucketMask;
+	}
+
+	void refreshBounds(Proxy& proxy)
+	{
+		const AABB globalAABB = proxy.entity->getGlobalAABB();
+		proxy.min = globalAABB.center - globalAABB.extents;
+		proxy.max = globalAABB.center + globalAABB.extents;
+		proxy.cellMin = toCell(proxy.min);
+		proxy.cellMax = toCell(proxy.max);
+	}
+
+	void addToCells(std::uint32_t proxyIndex, const glm::ivec3& cellMin, const glm::ivec3& cellMax)
+	{
+		for (int z = cellMin.z; z <= cellMax.z; ++z)
+			for (int y = cellMin.y; y <= cellMax.y; ++y)
+				for (int x = cellMin.x; x <= cellMax.x; ++x)
+				{
+					const glm::ivec3 cell{ x, y, z };
+					m_buckets[bucketOf(cell)].push_back({ cell, proxyIndex });
+				}
+	}
+
+	void removeFromCells(std::uint32_t proxyIndex, const glm::ivec3& cellMin, const glm::ivec3& cellMax)
+	{
+		for (int z = cellMin.z; z <= cellMax.z; ++z)
+			for (int y = cellMin.y; y <= cellMax.y; ++y)
+				for (int x = cellMin.x; x <= cellMax.x; ++x)
+				{
+					std::vector<CellEntry>& bucket = m_buckets[bucketOf({ x, y, z })];
+					for (std::size_t i = 0; i < bucket.size(); ++i)
+					{
+						if (bucket[i].proxyIndex == proxyIndex)
+						{
+							bucket[i] = bucket.back();
+							bucket.pop_back();
+							break;
+						}
+					}
+				}
+	}
+
+	void replaceInCells(std::uint32_t oldIndex, std::uint32_t newIndex, const glm::ivec3& cellMin, const glm::ivec3& cellMax)
+	{
+		for (int z = cellMin.z; z <= cellMax.z; ++z)
+			for (int y = cellMin.y; y <= cellMax.y; ++y)
+				for (int x = cellMin.x; x <= cellMax.x; ++x)
+				{
+					for (CellEntry& entry : m_buckets[bucketOf({ x, y, z })])
+					{
+						if (entry.proxyIndex == oldIndex)
+						{
+							entry.proxyIndex = newIndex;
+							break;
+						}
+					}
+				}
+	}
+
+	//Proxies spanning several cells are met several times per query, the stamp
+	//makes sure they are tested and reported only once without any per query allocation
+	std::uint32_t nextQueryStamp()
+	{
+		if (++m_queryStamp == 0)
+		{
+			for (Proxy& proxy : m_proxies)
+				proxy.stamp = 0;
+			m_queryStamp = 1;
+		}
+		return m_queryStamp;
+	}
+
+	static void emit(Entity* entity, Entity** result, std::size_t capacity, std::size_t& count)
+	{
+		if (count < capacity)
+			result[count] = entity;
+		++count;
+	}
+
+	//Slab test. Axes the ray is parallel to are tested on the origin alone: their inverse direction is infinite and an
+	//origin lying on a face would give 0 * inf = NaN.
+	static bool intersectRay(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& invDirection, float maxDistance, const glm::vec3& min, const glm::vec3& max)
+	{
+		float enter = 0.0f, exit = maxDistance;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (direction[axis] == 0.0f)
+			{
+				if (origin[axis] < min[axis] || origin[axis] > max[axis])
+					return false;
+				continue;
+			}
+			const float t0 = (min[axis] - origin[axis]) * invDirection[axis];
+			const float t1 = (max[axis] - origin[axis]) * invDirection[axis];
+			enter = std::max(enter, std::min(t0, t1));
+			exit = std::min(exit, std::max(t0, t1));
+		}
+		return enter <= exit;
+	}
+
+	float m_cellSize;
+	float m_invCellSize;
+	std::uint32_t m_bucketMask = 0;
+	std::uint32_t m_queryStamp = 0;
+	std::size_t m_movedCount = 0;
+	std::vector<std::vector<CellEntry>> m_buckets;
+	std::vector<Proxy> m_proxies;
+	std::vector<std::uint32_t> m_movedProxies;
+};
+#endif
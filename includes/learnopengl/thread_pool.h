@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*Fixed set of worker threads running data parallel loops.
+Every worker owns a queue: it pops its own tasks from the back and, once empty, steals from the front of the
+other queues, so uneven chunks balance themselves without a central queue everybody contends on.
+The thread calling ParallelFor takes part as worker 0.*/
+class ThreadPool
+{
+public:
+	/*threadCount is the number of workers including the calling thread*/
+	explicit ThreadPool(unsigned int threadCount = std::thread::hardware_concurrency())
+	{
+		if (threadCount == 0)
+			threadCount = 1;
+
+		for (unsigned int i = 0; i < threadCount; ++i)
+			m_Queues.emplace_back(new WorkQueue());
+
+		for (unsigned int i = 1; i < threadCount; ++i)
+			m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_Stop = true;
+		}
+		m_WakeUp.notify_all();
+		for (std::thread& thread : m_Threads)
+			thread.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_Queues.size()); }
+
+	/*Calls function(begin, end, workerIndex) over [0, count) in chunks of at most grainSize and returns once
+	every chunk ran. workerIndex is below GetWorkerCount() and can index per worker scratch memory.*/
+	template<typename TFunction>
+	void ParallelFor(std::size_t count, std::size_t grainSize, TFunction&& function)
+	{
+		if (count == 0)
+			return;
+		if (grainSize == 0)
+			grainSize = 1;
+
+		if (m_Queues.size() == 1 || count <= grainSize)
+		{
+			function(std::size_t(0), count, 0u);
+			return;
+		}
+
+		//TFunction is a reference type when function is an lvalue
+		typedef typename std::remove_reference<TFunction>::type Function;
+		Job job;
+		job.context = const_cast<void*>(static_cast<const void*>(&function));
+		job.invoke = [](void* context, std::size_t begin, std::size_t end, unsigned int workerIndex)
+		{
+			(*static_cast<Function*>(context))(begin, end, workerIndex);
+		};
+
+		const std::size_t chunkCount = (count + grainSize - 1) / grainSize;
+		job.remaining.store(chunkCount);
+		{
+			//counted before they are pushed so that the counter never drops below the number of queued tasks
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_QueuedTasks += chunkCount;
+		}
+		for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			const std::size_t begin = chunk * grainSize;
+			const std::size_t end = begin + grainSize < count ? begin + grainSize : count;
+			WorkQueue& queue = *m_Queues[chunk % m_Queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back({ &job, begin, end });
+		}
+
+		m_WakeUp.notify_all();
+
+		while (job.remaining.load(std::memory_order_acquire) != 0)
+		{
+			if (!RunOneTask(0))
+				std::this_thread::yield();
+		}
+	}
+
+	/*Tasks taken from another worker's queue since the pool was created*/
+	std::size_t GetStealCount() const { return m_StealCount.load(std::memory_order_relaxed); }
+
+private:
+	struct Job
+	{
+		void* context = nullptr;
+		void (*invoke)(void*, std::size_t, std::size_t, unsigned int) = nullptr;
+		std::atomic<std::size_t> remaining{ 0 };
+	};
+
+	struct Task
+	{
+		Job* job;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	bool PopTask(unsigned int workerIndex, Task& task)
+	{
+		{
+			WorkQueue& own = *m_Queues[workerIndex];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.tasks.empty())
+			{
+				task = own.tasks.back();
+				own.tasks.pop_back();
+				return true;
+			}
+		}
+
+		for (std::size_t offset = 1; offset < m_Queues.size(); ++offset)
+		{
+			WorkQueue& victim = *m_Queues[(workerIndex + offset) % m_Queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty())
+			{
+				task = victim.tasks.front();
+				victim.tasks.pop_front();
+				m_StealCount.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool RunOneTask(unsigned int workerIndex)
+	{
+		Task task;
+		if (!PopTask(workerIndex, task))
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			--m_QueuedTasks;
+		}
+		task.job->invoke(task.job->context, task.begin, task.end, workerIndex);
+		//the job lives on the stack of ParallelFor, it must not be touched after the last chunk completes
+		task.job->remaining.fetch_sub(1, std::memory_order_release);
+		return true;
+	}
+
+	void WorkerLoop(unsigned int workerIndex)
+	{
+		while (true)
+		{
+			if (RunOneTask(workerIndex))
+				continue;
+
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_WakeUp.wait(lock, [this] { return m_Stop || m_QueuedTasks != 0; });
+			if (m_Stop)
+				return;
+		}
+	}
+
+	std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+	std::vector<std::thread> m_Threads;
+
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeUp;
+	std::size_t m_QueuedTasks = 0;
+	bool m_Stop = false;
+
+	std::atomic<std::size_t> m_StealCount{ 0 };
+};
@@ -10,6 +10,7 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/render_queue.h>
 
 #include <iostream>
 
@@ -116,6 +117,10 @@ int main()
         modelMatrices[i] = model;
     }
 
+    // draws are sorted by program, material and depth before being executed
+    RenderQueue renderQueue;
+    bool stateChangesReported = false;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -142,19 +147,35 @@ int main()
         shader.setMat4("projection", projection);
         shader.setMat4("view", view);
 
+        renderQueue.begin(camera.Position, 0.1f, 1000.0f);
+
         // draw planet
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, -3.0f, 0.0f));
         model = glm::scale(model, glm::vec3(4.0f, 4.0f, 4.0f));
-        shader.setMat4("model", model);
-        planet.Draw(shader);
+        for (Mesh& mesh : planet.meshes)
+            renderQueue.submit(mesh, shader, model);
 
         // draw meteorites
         for (unsigned int i = 0; i < amount; i++)
         {
-            shader.setMat4("model", modelMatrices[i]);
-            rock.Draw(shader);
-        }     
+            for (Mesh& mesh : rock.meshes)
+                renderQueue.submit(mesh, shader, modelMatrices[i]);
+        }
+
+        renderQueue.sort();
+        renderQueue.execute();
+
+        if (!stateChangesReported)
+        {
+            // Model::Draw rebinds the textures and the VAO of every mesh it draws
+            const RenderStateChanges traversal = renderQueue.countSubmissionOrderStateChanges();
+            const RenderStateChanges sorted = renderQueue.countSortedStateChanges();
+            std::cout << "Draws : " << sorted.draws << " / Model::Draw binds : " << sorted.draws << " materials, " << sorted.draws << " VAOs" << std::endl;
+            std::cout << "Traversal order : " << traversal.programs << " programs, " << traversal.materials << " materials, " << traversal.vertexArrays << " VAOs" << std::endl;
+            std::cout << "Sorted          : " << sorted.programs << " programs, " << sorted.materials << " materials, " << sorted.vertexArrays << " VAOs" << std::endl;
+            stateChangesReported = true;
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -1,6 +1,6 @@
 #include <iostream>
-#include <map>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -9,29 +9,27 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <ft2build.h>
-#include FT_FREETYPE_H
-
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/sdf_font.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
-void RenderText(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color);
+void RenderText(std::string text, float x, float y, float scale, glm::vec3 color);
+void FlushText(Shader &shader);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
-/// Holds all state information relevant to a character as loaded using FreeType
-struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2   Size;      // Size of glyph
-    glm::ivec2   Bearing;   // Offset from baseline to left/top of glyph
-    unsigned int Advance;   // Horizontal offset to advance to next glyph
-};
+// size of the text in pixels at a scale of 1
+const float FONT_SIZE = 48.0f;
 
-std::map<GLchar, Character> Characters;
+// signed distance field atlas of the font's glyphs
+SdfFont Font;
+unsigned int AtlasTexture;
+// vertices of the text queued for the next FlushText: <vec2 pos, vec2 tex, vec3 color>
+std::vector<float> TextVertices;
 unsigned int VAO, VBO;
 
 int main()
@@ -80,16 +78,8 @@ int main()
     shader.use();
     glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
 
-    // FreeType
+    // SDF font
     // --------
-    FT_Library ft;
-    // All functions return a value different than 0 whenever an error occurred
-    if (FT_Init_FreeType(&ft))
-    {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-        return -1;
-    }
-
 	// find path to font
     std::string font_name = FileSystem::getPath("resources/fonts/Antonio-Bold.ttf");
     if (font_name.empty())
@@ -97,74 +87,30 @@ int main()
         std::cout << "ERROR::FREETYPE: Failed to load font_name" << std::endl;
         return -1;
     }
-	
-	// load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, font_name.c_str(), 0, &face)) {
+
+    // the glyphs' distance fields are generated with FreeType on worker threads the first time, and cached
+    // in the working directory; afterwards loading the font only reads the cache file. The distance field stays
+    // sharp at any scale, so this one atlas is used for every size of text
+    Font = SdfFont::LoadOrGenerate("Antonio-Bold.sdf", font_name, { { 0x20, 0x7E } });
+    if (Font.GetGlyphs().empty())
+    {
         std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
         return -1;
     }
-    else {
-        // set size to load glyphs as
-        FT_Set_Pixel_Sizes(face, 0, 48);
-
-        // disable byte-alignment restriction
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-        // load first 128 characters of ASCII set
-        for (unsigned char c = 0; c < 128; c++)
-        {
-            // Load character glyph 
-            if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-            {
-                std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-                continue;
-            }
-            // generate texture
-            unsigned int texture;
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                face->glyph->bitmap.width,
-                face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer
-            );
-            // set texture options
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            // now store character for later use
-            Character character = {
-                texture,
-                glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                static_cast<unsigned int>(face->glyph->advance.x)
-            };
-            Characters.insert(std::pair<char, Character>(c, character));
-        }
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-    // destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    AtlasTexture = Font.CreateTexture();
+    shader.setInt("text", 0);
 
     
-    // configure VAO/VBO for texture quads
-    // -----------------------------------
+    // configure VAO/VBO for the text quads of a frame
+    // -----------------------------------------------
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 7 * sizeof(float), 0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(4 * sizeof(float)));
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
@@ -181,8 +127,11 @@ int main()
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        RenderText(shader, "This is sample text", 25.0f, 25.0f, 1.0f, glm::vec3(0.5, 0.8f, 0.2f));
-        RenderText(shader, "(C) LearnOpenGL.com", 540.0f, 570.0f, 0.5f, glm::vec3(0.3, 0.7f, 0.9f));
+        RenderText("This is sample text", 25.0f, 25.0f, 1.0f, glm::vec3(0.5, 0.8f, 0.2f));
+        RenderText("(C) LearnOpenGL.com", 540.0f, 570.0f, 0.5f, glm::vec3(0.3, 0.7f, 0.9f));
+        RenderText("Any size", 25.0f, 250.0f, 3.0f, glm::vec3(0.9f, 0.6f, 0.2f));
+        // all text of the frame is drawn with one draw call
+        FlushText(shader);
        
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -212,49 +161,63 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 }
 
 
-// render line of text
-// -------------------
-void RenderText(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color)
+// queue a line of text
+// ---------------------
+void RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
 {
-    // activate corresponding render state	
-    shader.use();
-    glUniform3f(glGetUniformLocation(shader.ID, "textColor"), color.x, color.y, color.z);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
+    // glyph metrics are stored at the atlas' base size
+    scale *= FONT_SIZE / Font.GetBaseSize();
 
     // iterate through all characters
     std::string::const_iterator c;
     for (c = text.begin(); c != text.end(); c++) 
     {
-        Character ch = Characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },            
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }           
+        const SdfGlyph* ch = Font.GetGlyph(*c);
+        if (!ch)
+            continue;
+
+        float xpos = x + ch->bearing.x * scale;
+        float ypos = y - (ch->size.y - ch->bearing.y) * scale;
+
+        float w = ch->size.x * scale;
+        float h = ch->size.y * scale;
+        // the glyph's region of the atlas, stored top row first
+        float u0 = ch->uvRect.x, v0 = ch->uvRect.y;
+        float u1 = u0 + ch->uvRect.z, v1 = v0 + ch->uvRect.w;
+        float vertices[6][7] = {
+            { xpos,     ypos + h,   u0, v0,   color.r, color.g, color.b },
+            { xpos,     ypos,       u0, v1,   color.r, color.g, color.b },
+            { xpos + w, ypos,       u1, v1,   color.r, color.g, color.b },
+
+            { xpos,     ypos + h,   u0, v0,   color.r, color.g, color.b },
+            { xpos + w, ypos,       u1, v1,   color.r, color.g, color.b },
+            { xpos + w, ypos + h,   u1, v0,   color.r, color.g, color.b }
         };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+        // characters without a glyph (spaces) only advance the cursor
+        if (w > 0.0f)
+            TextVertices.insert(TextVertices.end(), &vertices[0][0], &vertices[0][0] + 6 * 7);
+        // now advance cursors for next glyph
+        x += ch->advance * scale;
     }
+}
+
+// render all queued text
+// ----------------------
+void FlushText(Shader &shader)
+{
+    if (TextVertices.empty())
+        return;
+    // activate corresponding render state	
+    shader.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, AtlasTexture);
+    glBindVertexArray(VAO);
+    // upload all quads at once (orphaning the previous frame's buffer) and render them
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, TextVertices.size() * sizeof(float), TextVertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(TextVertices.size() / 7));
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
+    TextVertices.clear();
 }
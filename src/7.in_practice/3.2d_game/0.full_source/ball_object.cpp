@@ -46,6 +46,7 @@ glm::vec2 BallObject::Move(float dt, unsigned int window_width)
 void BallObject::Reset(glm::vec2 position, glm::vec2 velocity)
 {
     this->Position = position;
+    this->PreviousPosition = position; // don't interpolate the jump back to the paddle
     this->Velocity = velocity;
     this->Stuck = true;
     this->Sticky = false;
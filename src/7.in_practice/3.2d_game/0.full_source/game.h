@@ -8,72 +8,42 @@
 ******************************************************************/
 #ifndef GAME_H
 #define GAME_H
+
 #include <vector>
-#include <tuple>
+#include <string>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include "game_level.h"
-#include "power_up.h"
-
-// Represents the current state of the game
-enum GameState {
-    GAME_ACTIVE,
-    GAME_MENU,
-    GAME_WIN
-};
-
-// Represents the four possible (collision) directions
-enum Direction {
-    UP,
-    RIGHT,
-    DOWN,
-    LEFT
-};
-// Defines a Collision typedef that represents collision data
-typedef std::tuple<bool, Direction, glm::vec2> Collision; // <collision?, what direction?, difference vector center - closest point>
-
-// Initial size of the player paddle
-const glm::vec2 PLAYER_SIZE(100.0f, 20.0f);
-// Initial velocity of the player paddle
-const float PLAYER_VELOCITY(500.0f);
-// Initial velocity of the Ball
-const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
-// Radius of the ball object
-const float BALL_RADIUS = 12.5f;
+#include "game_world.h"
+#include "replay.h"
 
 // Game holds all game-related state and functionality.
 // Combines all game-related data into a single class for
 // easy access to each of the components and manageability.
+// The game itself is simulated by its GameWorld, Game is the
+// front end that feeds it the keyboard input and renders and
+// plays sounds for it.
 class Game
 {
 public:
     // game state
-    GameState               State;	
+    GameWorld               World;
     bool                    Keys[1024];
     bool                    KeysProcessed[1024];
     unsigned int            Width, Height;
-    std::vector<GameLevel>  Levels;
-    std::vector<PowerUp>    PowerUps;
-    unsigned int            Level;
-    unsigned int            Lives;
+    Replay                 *Recording; // if set, every step's input and resulting state hash are appended to it
     // constructor/destructor
     Game(unsigned int width, unsigned int height);
     ~Game();
     // initialize game state (load all shaders/textures/levels)
     void Init();
+    // loads the levels, in order
+    static std::vector<LevelTiles> LoadLevels();
     // game loop
-    void ProcessInput(float dt);
-    void Update(float dt);
-    void Render();
-    void DoCollisions();
-    // reset
-    void ResetLevel();
-    void ResetPlayer();
-    // powerups
-    void SpawnPowerUps(GameObject &block);
-    void UpdatePowerUps(float dt);
+    void Step(float dt); // advances the simulation by one (fixed) step with the keys currently held down
+    unsigned int Input(); // the GameInput bits of the keys currently held down
+    void Render(float interpolation = 1.0f); // interpolation: how far rendering is between the last two steps
 };
 
 #endif
\ No newline at end of file
@@ -8,33 +8,31 @@
 ******************************************************************/
 #include "game_level.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 
 
 void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+{
+    // load from file
+    LevelTiles tiles;
+    tiles.Load(file);
+    this->Load(tiles, levelWidth, levelHeight);
+}
+
+void GameLevel::Load(const LevelTiles &tiles, unsigned int levelWidth, unsigned int levelHeight)
 {
     // clear old data
     this->Bricks.clear();
-    // load from file
-    unsigned int tileCode;
-    GameLevel level;
-    std::string line;
-    std::ifstream fstream(file);
-    std::vector<std::vector<unsigned int>> tileData;
-    if (fstream)
-    {
-        while (std::getline(fstream, line)) // read each line from level file
-        {
-            std::istringstream sstream(line);
-            std::vector<unsigned int> row;
-            while (sstream >> tileCode) // read each word separated by spaces
-                row.push_back(tileCode);
-            tileData.push_back(row);
-        }
-        if (tileData.size() > 0)
-            this->init(tileData, levelWidth, levelHeight);
-    }
+    this->BrickGrid.Clear();
+    if (tiles.Rows > 0 && tiles.Columns > 0)
+        this->init(tiles, levelWidth, levelHeight);
+    this->pristineBricks = this->Bricks;
+}
+
+void GameLevel::Reset()
+{
+    // same number of bricks, so this copies in place without allocating; the grid stays valid as bricks don't move
+    std::copy(this->pristineBricks.begin(), this->pristineBricks.end(), this->Bricks.begin());
 }
 
 void GameLevel::Draw(SpriteRenderer &renderer)
@@ -44,6 +42,13 @@ void GameLevel::Draw(SpriteRenderer &renderer)
             tile.Draw(renderer);
 }
 
+void GameLevel::Draw(SpriteBatch &batch)
+{
+    for (GameObject &tile : this->Bricks)
+        if (!tile.Destroyed)
+            tile.Draw(batch);
+}
+
 bool GameLevel::IsCompleted()
 {
     for (GameObject &tile : this->Bricks)
@@ -52,42 +57,54 @@ bool GameLevel::IsCompleted()
     return true;
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::init(const LevelTiles &tiles, unsigned int levelWidth, unsigned int levelHeight)
 {
     // calculate dimensions
-    unsigned int height = tileData.size();
-    unsigned int width = tileData[0].size(); // note we can index vector at [0] since this function is only called if height > 0
-    float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / height; 
-    // initialize level tiles based on tileData		
+    unsigned int height = tiles.Rows;
+    unsigned int width = tiles.Columns;
+    float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / static_cast<float>(height); 
+    // look up the sprites once for all bricks
+    Texture2D &solidTexture = ResourceManager::GetTexture("block_solid"), &blockTexture = ResourceManager::GetTexture("block");
+    glm::vec4 solidRect = ResourceManager::GetTextureRect("block_solid"), blockRect = ResourceManager::GetTextureRect("block");
+    this->Bricks.reserve(width * height);
+    // initialize level tiles based on tile data
     for (unsigned int y = 0; y < height; ++y)
     {
         for (unsigned int x = 0; x < width; ++x)
         {
+            unsigned int tileCode = tiles.Get(x, y);
             // check block type from level data (2D level array)
-            if (tileData[y][x] == 1) // solid
+            if (tileCode == 1) // solid
             {
                 glm::vec2 pos(unit_width * x, unit_height * y);
                 glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
+                GameObject obj(pos, size, solidTexture, glm::vec3(0.8f, 0.8f, 0.7f));
+                obj.SpriteRect = solidRect;
                 obj.IsSolid = true;
                 this->Bricks.push_back(obj);
             }
-            else if (tileData[y][x] > 1)	// non-solid; now determine its color based on level data
+            else if (tileCode > 1)	// non-solid; now determine its color based on level data
             {
                 glm::vec3 color = glm::vec3(1.0f); // original: white
-                if (tileData[y][x] == 2)
+                if (tileCode == 2)
                     color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
+                else if (tileCode == 3)
                     color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
+                else if (tileCode == 4)
                     color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
+                else if (tileCode == 5)
                     color = glm::vec3(1.0f, 0.5f, 0.0f);
 
                 glm::vec2 pos(unit_width * x, unit_height * y);
                 glm::vec2 size(unit_width, unit_height);
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
+                GameObject obj(pos, size, blockTexture, color);
+                obj.SpriteRect = blockRect;
+                this->Bricks.push_back(obj);
             }
         }
     }
+    // bucket the bricks in a grid of tile sized cells
+    this->BrickGrid.Reset(glm::vec2(0.0f), glm::vec2(levelWidth, levelHeight), glm::vec2(unit_width, unit_height));
+    for (unsigned int i = 0; i < this->Bricks.size(); ++i)
+        this->BrickGrid.Insert(i, this->Bricks[i].Position, this->Bricks[i].Size);
 }
\ No newline at end of file
@@ -15,7 +15,10 @@
 
 #include "game_object.h"
 #include "sprite_renderer.h"
+#include "sprite_batch.h"
 #include "resource_manager.h"
+#include "uniform_grid.h"
+#include "level_tiles.h"
 
 
 /// GameLevel holds all Tiles as part of a Breakout level and 
@@ -25,17 +28,27 @@ class GameLevel
 public:
     // level state
     std::vector<GameObject> Bricks;
+    // broadphase over Bricks; bricks never move so it's only built when the level is loaded
+    UniformGrid             BrickGrid;
     // constructor
     GameLevel() { }
-    // loads level from file
+    // loads level from a text or binary level file
     void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
+    // loads level from tile data
+    void Load(const LevelTiles &tiles, unsigned int levelWidth, unsigned int levelHeight);
+    // restores all bricks as they were loaded
+    void Reset();
     // render level
     void Draw(SpriteRenderer &renderer);
+    // record level into a batch; bricks never overlap, so the batch may be sorted by texture
+    void Draw(SpriteBatch &batch);
     // check if the level is completed (all non-solid tiles are destroyed)
     bool IsCompleted();
 private:
+    // the bricks as they were loaded; bricks only change by being destroyed, so copying these back resets the level
+    std::vector<GameObject> pristineBricks;
     // initialize level from tile data
-    void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
+    void init(const LevelTiles &tiles, unsigned int levelWidth, unsigned int levelHeight);
 };
 
 #endif
\ No newline at end of file
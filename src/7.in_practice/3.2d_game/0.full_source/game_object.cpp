@@ -10,12 +10,17 @@
 
 
 GameObject::GameObject() 
-    : Position(0.0f, 0.0f), Size(1.0f, 1.0f), Velocity(0.0f), Color(1.0f), Rotation(0.0f), Sprite(), IsSolid(false), Destroyed(false) { }
+    : Position(0.0f, 0.0f), Size(1.0f, 1.0f), Velocity(0.0f), PreviousPosition(0.0f, 0.0f), Color(1.0f), Rotation(0.0f), Sprite(), SpriteRect(0.0f, 0.0f, 1.0f, 1.0f), IsSolid(false), Destroyed(false) { }
 
 GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color, glm::vec2 velocity) 
-    : Position(pos), Size(size), Velocity(velocity), Color(color), Rotation(0.0f), Sprite(sprite), IsSolid(false), Destroyed(false) { }
+    : Position(pos), Size(size), Velocity(velocity), PreviousPosition(pos), Color(color), Rotation(0.0f), Sprite(sprite), SpriteRect(0.0f, 0.0f, 1.0f, 1.0f), IsSolid(false), Destroyed(false) { }
 
-void GameObject::Draw(SpriteRenderer &renderer)
+void GameObject::Draw(SpriteRenderer &renderer, float interpolation)
 {
-    renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color);
+    renderer.DrawSprite(this->Sprite, glm::mix(this->PreviousPosition, this->Position, interpolation), this->Size, this->Rotation, this->Color, this->SpriteRect);
+}
+
+void GameObject::Draw(SpriteBatch &batch, float interpolation)
+{
+    batch.DrawSprite(this->Sprite, glm::mix(this->PreviousPosition, this->Position, interpolation), this->Size, this->Rotation, this->Color, this->SpriteRect);
 }
\ No newline at end of file
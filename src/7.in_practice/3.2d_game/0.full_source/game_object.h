@@ -14,6 +14,7 @@
 
 #include "texture.h"
 #include "sprite_renderer.h"
+#include "sprite_batch.h"
 
 
 // Container object for holding all state relevant for a single
@@ -24,17 +25,21 @@ class GameObject
 public:
     // object state
     glm::vec2   Position, Size, Velocity;
+    glm::vec2   PreviousPosition; // Position at the start of the last simulation step, to interpolate rendering between steps
     glm::vec3   Color;
     float       Rotation;
     bool        IsSolid;
     bool        Destroyed;
     // render state
     Texture2D   Sprite;	
+    glm::vec4   SpriteRect; // part of Sprite to render: <vec2 offset, vec2 size> in texture coordinates
     // constructor(s)
     GameObject();
     GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
-    // draw sprite
-    virtual void Draw(SpriteRenderer &renderer);
+    // draw sprite; interpolation blends from PreviousPosition (0.0) to Position (1.0)
+    virtual void Draw(SpriteRenderer &renderer, float interpolation = 1.0f);
+    // record sprite into a batch
+    virtual void Draw(SpriteBatch &batch, float interpolation = 1.0f);
 };
 
 #endif
\ No newline at end of file
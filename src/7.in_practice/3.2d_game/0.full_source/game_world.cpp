@@ -0,0 +1,650 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include <algorithm>
+#include <cmath>
+
+#include "game_world.h"
+#include "resource_manager.h"
+
+
+// Defines how each type of PowerUp spawns
+struct PowerUpInfo {
+    unsigned int Chance;   // spawns with a chance of 1 in Chance for each destroyed brick
+    glm::vec3    Color;
+    float        Duration; // 0 for PowerUps with a permanent effect
+    const char  *Texture;
+};
+static const PowerUpInfo POWERUP_INFO[POWERUP_COUNT] = {
+    { 75, glm::vec3(0.5f, 0.5f, 1.0f),   0.0f,  "powerup_speed" },
+    { 75, glm::vec3(1.0f, 0.5f, 1.0f),   20.0f, "powerup_sticky" },
+    { 75, glm::vec3(0.5f, 1.0f, 0.5f),   10.0f, "powerup_passthrough" },
+    { 75, glm::vec3(1.0f, 0.6f, 0.4),    0.0f,  "powerup_increase" },
+    { 15, glm::vec3(1.0f, 0.3f, 0.3f),   15.0f, "powerup_confuse" }, // Negative powerups should spawn more often
+    { 15, glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, "powerup_chaos" }
+};
+
+
+GameWorld::GameWorld(unsigned int width, unsigned int height, std::uint64_t seed)
+    : State(GAME_MENU), Width(width), Height(height), Level(0), Lives(3), RNG(seed), Tick(0),
+      Shake(false), Confuse(false), Chaos(false), ShakeTime(0.0f), Events(0), powerUpTextures(), previousInput(0)
+{
+
+}
+
+void GameWorld::Init(const std::vector<LevelTiles> &levels)
+{
+    // load levels
+    this->Levels.resize(levels.size());
+    for (unsigned int i = 0; i < levels.size(); ++i)
+        this->Levels[i].Load(levels[i], this->Width, this->Height / 2);
+    this->Level = 0;
+    this->powerUpGrid.Reset(glm::vec2(0.0f), glm::vec2(this->Width, this->Height), glm::vec2(100.0f, 100.0f));
+    for (unsigned int type = 0; type < POWERUP_COUNT; ++type)
+        this->powerUpTextures[type] = ResourceManager::GetTextureHandle(POWERUP_INFO[type].Texture);
+    // configure game objects
+    glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+    this->Player = GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
+    this->Player.SpriteRect = ResourceManager::GetTextureRect("paddle");
+    glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
+    this->Ball = BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+    this->Ball.SpriteRect = ResourceManager::GetTextureRect("face");
+}
+
+void GameWorld::Step(float dt, unsigned int input)
+{
+    this->Events = 0;
+    // remember where the moving objects start this step, rendering interpolates from there
+    this->Player.PreviousPosition = this->Player.Position;
+    this->Ball.PreviousPosition = this->Ball.Position;
+    for (PowerUp &powerUp : this->PowerUps)
+        powerUp.PreviousPosition = powerUp.Position;
+    this->processInput(dt, input);
+    this->update(dt);
+    this->previousInput = input;
+    ++this->Tick;
+}
+
+// FNV-1a over the bytes of a value
+template <typename T>
+static void hashValue(std::uint64_t &hash, const T &value)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&value);
+    for (size_t i = 0; i < sizeof(T); ++i)
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+}
+
+std::uint64_t GameWorld::Hash() const
+{
+    // floats are hashed by their bits: a deterministic simulation reproduces them exactly
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    hashValue(hash, this->State);
+    hashValue(hash, this->Level);
+    hashValue(hash, this->Lives);
+    hashValue(hash, this->Tick);
+    hashValue(hash, this->RNG.State);
+    hashValue(hash, this->previousInput);
+    hashValue(hash, this->ShakeTime);
+    hashValue(hash, this->Shake);
+    hashValue(hash, this->Confuse);
+    hashValue(hash, this->Chaos);
+    hashValue(hash, this->Player.Position);
+    hashValue(hash, this->Player.Size);
+    hashValue(hash, this->Ball.Position);
+    hashValue(hash, this->Ball.Velocity);
+    hashValue(hash, this->Ball.Stuck);
+    hashValue(hash, this->Ball.Sticky);
+    hashValue(hash, this->Ball.PassThrough);
+    hashValue(hash, this->ActivePowerUps.to_ulong());
+    for (const PowerUp &powerUp : this->PowerUps)
+    {
+        hashValue(hash, powerUp.Type);
+        hashValue(hash, powerUp.Position);
+        hashValue(hash, powerUp.Duration);
+        hashValue(hash, powerUp.Activated);
+        hashValue(hash, powerUp.Destroyed);
+    }
+    for (const GameLevel &level : this->Levels)
+        for (const GameObject &brick : level.Bricks)
+            hashValue(hash, brick.Destroyed);
+    return hash;
+}
+
+void GameWorld::update(float dt)
+{
+    // update objects; the ball is swept against the bricks and walls so it can't tunnel through them
+    this->MoveBall(dt);
+    // check for collisions
+    this->DoCollisions();
+    // update PowerUps
+    this->UpdatePowerUps(dt);
+    // reduce shake time
+    if (this->ShakeTime > 0.0f)
+    {
+        this->ShakeTime -= dt;
+        if (this->ShakeTime <= 0.0f)
+            this->Shake = false;
+    }
+    // check loss condition
+    if (this->Ball.Position.y >= this->Height) // did ball reach bottom edge?
+    {
+        --this->Lives;
+        // did the player lose all his lives? : game over
+        if (this->Lives == 0)
+        {
+            this->ResetLevel();
+            this->State = GAME_MENU;
+        }
+        this->ResetPlayer();
+    }
+    // check win condition
+    if (this->State == GAME_ACTIVE && this->Levels[this->Level].IsCompleted())
+    {
+        this->ResetLevel();
+        this->ResetPlayer();
+        this->Chaos = true;
+        this->State = GAME_WIN;
+    }
+}
+
+void GameWorld::processInput(float dt, unsigned int input)
+{
+    // keys that weren't held down in the previous step
+    unsigned int pressed = input & ~this->previousInput;
+    if (this->State == GAME_MENU)
+    {
+        if (pressed & INPUT_CONFIRM)
+            this->State = GAME_ACTIVE;
+        if (pressed & INPUT_NEXT)
+            this->Level = (this->Level + 1) % this->Levels.size();
+        if (pressed & INPUT_PREVIOUS)
+        {
+            if (this->Level > 0)
+                --this->Level;
+            else
+                this->Level = this->Levels.size() - 1;
+        }
+    }
+    if (this->State == GAME_WIN)
+    {
+        if (input & INPUT_CONFIRM)
+        {
+            this->Chaos = false;
+            this->State = GAME_MENU;
+        }
+    }
+    if (this->State == GAME_ACTIVE)
+    {
+        float velocity = PLAYER_VELOCITY * dt;
+        // move playerboard
+        if (input & INPUT_LEFT)
+        {
+            if (this->Player.Position.x >= 0.0f)
+            {
+                this->Player.Position.x -= velocity;
+                if (this->Ball.Stuck)
+                    this->Ball.Position.x -= velocity;
+            }
+        }
+        if (input & INPUT_RIGHT)
+        {
+            if (this->Player.Position.x <= this->Width - this->Player.Size.x)
+            {
+                this->Player.Position.x += velocity;
+                if (this->Ball.Stuck)
+                    this->Ball.Position.x += velocity;
+            }
+        }
+        if (input & INPUT_LAUNCH)
+            this->Ball.Stuck = false;
+    }
+}
+
+
+void GameWorld::ResetLevel()
+{
+    // restore the bricks as they were loaded in Init, without touching the disk
+    this->Levels[this->Level].Reset();
+
+    this->Lives = 3;
+}
+
+void GameWorld::ResetPlayer()
+{
+    // reset player/ball stats
+    this->Player.Size = PLAYER_SIZE;
+    this->Player.Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+    this->Player.PreviousPosition = this->Player.Position;
+    this->Ball.Reset(this->Player.Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
+    // also disable all active powerups
+    this->Chaos = this->Confuse = false;
+    this->Ball.PassThrough = this->Ball.Sticky = false;
+    this->Player.Color = glm::vec3(1.0f);
+    this->Ball.Color = glm::vec3(1.0f);
+}
+
+
+// powerups
+void GameWorld::UpdatePowerUps(float dt)
+{
+    // collect the types that are still active after this step
+    std::bitset<POWERUP_COUNT> active;
+    for (PowerUp &powerUp : this->PowerUps)
+    {
+        powerUp.Position += powerUp.Velocity * dt;
+        // check if powerup passed bottom edge, if so: keep as inactive and destroy
+        if (!powerUp.Destroyed && powerUp.Position.y >= this->Height)
+            powerUp.Destroyed = true;
+        if (powerUp.Activated)
+        {
+            powerUp.Duration -= dt;
+            if (powerUp.Duration <= 0.0f)
+                powerUp.Activated = false; // remove powerup from list (will later be removed)
+            else
+                active.set(powerUp.Type);
+        }
+    }
+    // deactivate the effects of the types that are no longer active; while another PowerUp of the same type is still active, its effect stays
+    std::bitset<POWERUP_COUNT> expired = this->ActivePowerUps & ~active;
+    this->ActivePowerUps = active;
+    if (expired[POWERUP_STICKY])
+    {
+        this->Ball.Sticky = false;
+        this->Player.Color = glm::vec3(1.0f);
+    }
+    if (expired[POWERUP_PASS_THROUGH])
+    {
+        this->Ball.PassThrough = false;
+        this->Ball.Color = glm::vec3(1.0f);
+    }
+    if (expired[POWERUP_CONFUSE])
+        this->Confuse = false;
+    if (expired[POWERUP_CHAOS])
+        this->Chaos = false;
+    // Remove all PowerUps from vector that are destroyed AND !activated (thus either off the map or finished)
+    // Note we use a lambda expression to remove each PowerUp which is destroyed and not activated
+    this->PowerUps.erase(std::remove_if(this->PowerUps.begin(), this->PowerUps.end(),
+        [](const PowerUp &powerUp) { return powerUp.Destroyed && !powerUp.Activated; }
+    ), this->PowerUps.end());
+}
+
+void GameWorld::SpawnPowerUps(GameObject &block)
+{
+    // all chances are drawn from the game's own generator, in a fixed order, so spawning is reproducible
+    for (unsigned int type = 0; type < POWERUP_COUNT; ++type)
+    {
+        const PowerUpInfo &info = POWERUP_INFO[type];
+        if (this->RNG.Range(info.Chance) == 0)
+        {
+            TextureHandle texture = this->powerUpTextures[type];
+            this->PowerUps.push_back(PowerUp(static_cast<PowerUpType>(type), info.Color, info.Duration, block.Position,
+                ResourceManager::GetTexture(texture), ResourceManager::GetTextureRect(texture)));
+        }
+    }
+}
+
+void GameWorld::ActivatePowerUp(PowerUp &powerUp)
+{
+    switch (powerUp.Type)
+    {
+    case POWERUP_SPEED:
+        this->Ball.Velocity *= 1.2;
+        break;
+    case POWERUP_STICKY:
+        this->Ball.Sticky = true;
+        this->Player.Color = glm::vec3(1.0f, 0.5f, 1.0f);
+        break;
+    case POWERUP_PASS_THROUGH:
+        this->Ball.PassThrough = true;
+        this->Ball.Color = glm::vec3(1.0f, 0.5f, 0.5f);
+        break;
+    case POWERUP_PAD_SIZE_INCREASE:
+        this->Player.Size.x += 50;
+        break;
+    case POWERUP_CONFUSE:
+        if (!this->Chaos)
+            this->Confuse = true; // only activate if chaos wasn't already active
+        break;
+    case POWERUP_CHAOS:
+        if (!this->Confuse)
+            this->Chaos = true;
+        break;
+    default:
+        break;
+    }
+    if (powerUp.Duration > 0.0f)
+        this->ActivePowerUps.set(powerUp.Type);
+}
+
+
+// collision detection
+void GameWorld::MoveBall(float dt)
+{
+    if (this->Ball.Stuck)
+        return;
+    // sweep the ball along its path and stop at the first brick, paddle or window edge it touches; after bouncing
+    // off it, sweep the rest of the path. The number of bounces per step is limited, as a ball trapped between
+    // solid bricks could otherwise bounce forever; it then just stops for the rest of the step
+    const unsigned int MAX_BOUNCES = 4;
+    BallObject &ball = this->Ball;
+    GameLevel &level = this->Levels[this->Level];
+    float remaining = 1.0f; // part of this step's movement still to do
+    for (unsigned int bounce = 0; bounce < MAX_BOUNCES && remaining > 0.0f; ++bounce)
+    {
+        glm::vec2 delta = ball.Velocity * dt * remaining;
+        glm::vec2 sweptMin = glm::min(ball.Position, ball.Position + delta);
+        glm::vec2 sweptMax = glm::max(ball.Position, ball.Position + delta) + ball.Size;
+        level.BrickGrid.Query(sweptMin, sweptMax - sweptMin, this->collisionCandidates);
+        // find the earliest hit; on ties the brick with the lowest index wins, so the result doesn't depend on the query order
+        bool hit = false;
+        GameObject *first = nullptr; // the brick or paddle hit, or nullptr for a window edge
+        float firstTime = 1.0f;
+        glm::vec2 firstNormal(0.0f);
+        for (unsigned int index : this->collisionCandidates)
+        {
+            GameObject &box = level.Bricks[index];
+            float time;
+            glm::vec2 normal;
+            if (!box.Destroyed && SweepCollision(ball, delta, box, time, normal) && (!hit || time < firstTime))
+            {
+                hit = true;
+                first = &box;
+                firstTime = time;
+                firstNormal = normal;
+            }
+        }
+        // the paddle, which has already moved for this step
+        float paddleTime;
+        glm::vec2 paddleNormal;
+        if (SweepCollision(ball, delta, this->Player, paddleTime, paddleNormal) && (!hit || paddleTime < firstTime))
+        {
+            hit = true;
+            first = &this->Player;
+            firstTime = paddleTime;
+            firstNormal = paddleNormal;
+        }
+        // the left, right and top window edges (not the bottom one) bounce the ball as well
+        auto hitEdge = [&](float time, glm::vec2 normal) {
+            time = std::max(time, 0.0f);
+            if (!hit || time < firstTime)
+            {
+                hit = true;
+                first = nullptr;
+                firstTime = time;
+                firstNormal = normal;
+            }
+        };
+        glm::vec2 end = ball.Position + delta;
+        if (delta.x < 0.0f && end.x < 0.0f)
+            hitEdge(-ball.Position.x / delta.x, glm::vec2(1.0f, 0.0f));
+        if (delta.x > 0.0f && end.x + ball.Size.x > this->Width)
+            hitEdge((this->Width - ball.Size.x - ball.Position.x) / delta.x, glm::vec2(-1.0f, 0.0f));
+        if (delta.y < 0.0f && end.y < 0.0f)
+            hitEdge(-ball.Position.y / delta.y, glm::vec2(0.0f, 1.0f));
+        if (!hit)
+        {
+            ball.Position += delta;
+            break;
+        }
+        if (first == nullptr)
+        {
+            ball.Position += delta * firstTime;
+            ball.Velocity = glm::reflect(ball.Velocity, firstNormal);
+        }
+        else
+        {
+            // move up to the contact point, backing off a hundredth of a pixel so the ball doesn't overlap
+            // the brick or paddle (DoCollisions would then resolve the same hit again)
+            float length = glm::length(delta);
+            ball.Position += delta * std::max(firstTime - 0.01f / length, 0.0f);
+            if (first == &this->Player)
+                this->HitPaddle(); // sets the new direction itself
+            else
+            {
+                this->HitBrick(*first);
+                if (!(ball.PassThrough && !first->IsSolid)) // don't bounce off non-solid bricks if pass-through is activated
+                    ball.Velocity = glm::reflect(ball.Velocity, firstNormal);
+            }
+        }
+        // a sticky paddle holds on to the ball for the rest of the step
+        if (ball.Stuck)
+            break;
+        remaining *= 1.0f - firstTime;
+    }
+}
+
+void GameWorld::HitBrick(GameObject &brick)
+{
+    // destroy block if not solid
+    if (!brick.IsSolid)
+    {
+        brick.Destroyed = true;
+        this->SpawnPowerUps(brick);
+        this->Events |= EVENT_BRICK_DESTROYED;
+    }
+    else
+    {   // if block is solid, enable shake effect
+        this->ShakeTime = 0.05f;
+        this->Shake = true;
+        this->Events |= EVENT_SOLID_HIT;
+    }
+}
+
+void GameWorld::HitPaddle()
+{
+    BallObject &ball = this->Ball;
+    // check where it hit the board, and change velocity based on where it hit the board
+    float centerBoard = this->Player.Position.x + this->Player.Size.x / 2.0f;
+    float distance = (ball.Position.x + ball.Radius) - centerBoard;
+    float percentage = distance / (this->Player.Size.x / 2.0f);
+    // then move accordingly
+    float strength = 2.0f;
+    glm::vec2 oldVelocity = ball.Velocity;
+    ball.Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+    //ball.Velocity.y = -ball.Velocity.y;
+    ball.Velocity = glm::normalize(ball.Velocity) * glm::length(oldVelocity); // keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
+    // fix sticky paddle
+    ball.Velocity.y = -1.0f * std::abs(ball.Velocity.y);
+
+    // if Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
+    ball.Stuck = ball.Sticky;
+
+    this->Events |= EVENT_PADDLE_HIT;
+}
+
+void GameWorld::DoCollisions()
+{
+    // MoveBall stops the ball before it touches a brick, so this is only a safety net for overlaps that slip through
+    // (e.g. by rounding). Only test the bricks in the grid cells around the ball; the query box has a margin of one radius
+    // as resolving a collision moves the ball (by less than its radius) before the next brick is tested
+    BallObject &ball = this->Ball;
+    GameLevel &level = this->Levels[this->Level];
+    level.BrickGrid.Query(ball.Position - ball.Radius, glm::vec2(ball.Radius * 4.0f), this->collisionCandidates);
+    for (unsigned int index : this->collisionCandidates)
+    {
+        GameObject &box = level.Bricks[index];
+        if (!box.Destroyed)
+        {
+            Collision collision = CheckCollision(ball, box);
+            if (std::get<0>(collision)) // if collision is true
+            {
+                this->HitBrick(box);
+                // collision resolution
+                if (!(ball.PassThrough && !box.IsSolid)) // don't do collision resolution on non-solid bricks if pass-through is activated
+                    ResolveCollision(ball, collision);
+            }
+        }
+    }
+
+    // also check collisions on PowerUps and if so, activate them
+    this->powerUpGrid.Clear();
+    for (unsigned int i = 0; i < this->PowerUps.size(); ++i)
+        if (!this->PowerUps[i].Destroyed)
+            this->powerUpGrid.Insert(i, this->PowerUps[i].Position, this->PowerUps[i].Size);
+    this->powerUpGrid.Query(this->Player.Position, this->Player.Size, this->collisionCandidates);
+    for (unsigned int index : this->collisionCandidates)
+    {
+        PowerUp &powerUp = this->PowerUps[index];
+        if (CheckCollision(this->Player, powerUp))
+        {	// collided with player, now activate powerup
+            this->ActivatePowerUp(powerUp);
+            powerUp.Destroyed = true;
+            powerUp.Activated = true;
+            this->Events |= EVENT_POWERUP;
+        }
+    }
+
+    // and finally check collisions for player pad (unless stuck); MoveBall already sweeps the ball against it,
+    // this only catches the paddle moving into the ball from the side
+    Collision result = CheckCollision(ball, this->Player);
+    if (!ball.Stuck && std::get<0>(result))
+        this->HitPaddle();
+}
+
+bool CheckCollision(GameObject &one, GameObject &two) // AABB - AABB collision
+{
+    // collision x-axis?
+    bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
+        two.Position.x + two.Size.x >= one.Position.x;
+    // collision y-axis?
+    bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
+        two.Position.y + two.Size.y >= one.Position.y;
+    // collision only if on both axes
+    return collisionX && collisionY;
+}
+
+Collision CheckCollision(BallObject &one, GameObject &two) // AABB - Circle collision
+{
+    // get center point circle first 
+    glm::vec2 center(one.Position + one.Radius);
+    // calculate AABB info (center, half-extents)
+    glm::vec2 aabb_half_extents(two.Size.x / 2.0f, two.Size.y / 2.0f);
+    glm::vec2 aabb_center(two.Position.x + aabb_half_extents.x, two.Position.y + aabb_half_extents.y);
+    // get difference vector between both centers
+    glm::vec2 difference = center - aabb_center;
+    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
+    // now that we know the clamped values, add this to AABB_center and we get the value of box closest to circle
+    glm::vec2 closest = aabb_center + clamped;
+    // now retrieve vector between center circle and closest point AABB and check if length < radius (compared squared, saving a sqrt)
+    difference = closest - center;
+    
+    if (glm::dot(difference, difference) < one.Radius * one.Radius) // not <= since in that case a collision also occurs when object one exactly touches object two, which they are at the end of each collision resolution stage.
+        return std::make_tuple(true, VectorDirection(difference), difference);
+    else
+        return std::make_tuple(false, UP, glm::vec2(0.0f, 0.0f));
+}
+
+// calculates which direction a vector is facing (N,E,S or W)
+Direction VectorDirection(glm::vec2 target)
+{
+    glm::vec2 compass[] = {
+        glm::vec2(0.0f, 1.0f),	// up
+        glm::vec2(1.0f, 0.0f),	// right
+        glm::vec2(0.0f, -1.0f),	// down
+        glm::vec2(-1.0f, 0.0f)	// left
+    };
+    float max = 0.0f;
+    unsigned int best_match = -1;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        float dot_product = glm::dot(target, compass[i]); // no need to normalize target, scaling it doesn't change which direction matches best
+        if (dot_product > max)
+        {
+            max = dot_product;
+            best_match = i;
+        }
+    }
+    return (Direction)best_match;
+}
+
+void ResolveCollision(BallObject &ball, Collision collision)
+{
+    Direction dir = std::get<1>(collision);
+    glm::vec2 diff_vector = std::get<2>(collision);
+    if (dir == LEFT || dir == RIGHT) // horizontal collision
+    {
+        ball.Velocity.x = -ball.Velocity.x; // reverse horizontal velocity
+        // relocate
+        float penetration = ball.Radius - std::abs(diff_vector.x);
+        if (dir == LEFT)
+            ball.Position.x += penetration; // move ball to right
+        else
+            ball.Position.x -= penetration; // move ball to left;
+    }
+    else // vertical collision
+    {
+        ball.Velocity.y = -ball.Velocity.y; // reverse vertical velocity
+        // relocate
+        float penetration = ball.Radius - std::abs(diff_vector.y);
+        if (dir == UP)
+            ball.Position.y -= penetration; // move ball bback up
+        else
+            ball.Position.y += penetration; // move ball back down
+    }
+}
+
+bool SweepCollision(BallObject &one, glm::vec2 delta, GameObject &two, float &time, glm::vec2 &normal) // swept Circle - AABB collision
+{
+    // the circle touches the AABB when its center is inside the AABB grown by the radius (with rounded corners),
+    // so sweep the center as a ray against the grown AABB first (slab test)
+    if (delta == glm::vec2(0.0f))
+        return false;
+    glm::vec2 center(one.Position + one.Radius);
+    glm::vec2 boxMin = two.Position, boxMax = two.Position + two.Size;
+    float enter = 0.0f, leave = 1.0f;
+    normal = glm::vec2(0.0f);
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        float low = boxMin[axis] - one.Radius, high = boxMax[axis] + one.Radius;
+        if (delta[axis] == 0.0f)
+        {
+            if (center[axis] < low || center[axis] > high) // parallel to and outside the slab
+                return false;
+            continue;
+        }
+        float t0 = (low - center[axis]) / delta[axis], t1 = (high - center[axis]) / delta[axis];
+        float side = -1.0f; // entering through the low side
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+            side = 1.0f;
+        }
+        if (t0 > enter)
+        {
+            enter = t0;
+            normal = glm::vec2(0.0f);
+            normal[axis] = side;
+        }
+        leave = std::min(leave, t1);
+        if (enter > leave)
+            return false;
+    }
+    // entering beside a corner of the AABB (outside it on both axes), the ball really hits the corner's rounding:
+    // intersect the ray with a circle of the ball's radius around the corner
+    glm::vec2 hit = center + delta * enter;
+    if ((hit.x < boxMin.x || hit.x > boxMax.x) && (hit.y < boxMin.y || hit.y > boxMax.y))
+    {
+        glm::vec2 corner = glm::clamp(hit, boxMin, boxMax);
+        glm::vec2 offset = center - corner;
+        float a = glm::dot(delta, delta);
+        float b = glm::dot(offset, delta);
+        float c = glm::dot(offset, offset) - one.Radius * one.Radius;
+        float discriminant = b * b - a * c;
+        if (c < 0.0f || discriminant < 0.0f) // already touching the corner, or passing it
+            return false;
+        enter = (-b - std::sqrt(discriminant)) / a;
+        if (enter < 0.0f || enter > 1.0f)
+            return false;
+        normal = glm::normalize(center + delta * enter - corner);
+    }
+    // no entering side: the ball already overlaps the AABB at the start, that's left to the discrete test
+    else if (normal == glm::vec2(0.0f))
+        return false;
+    time = enter;
+    return true;
+}
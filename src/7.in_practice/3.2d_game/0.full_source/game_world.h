@@ -0,0 +1,138 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GAME_WORLD_H
+#define GAME_WORLD_H
+#include <vector>
+#include <string>
+#include <tuple>
+#include <bitset>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "game_level.h"
+#include "power_up.h"
+#include "ball_object.h"
+#include "uniform_grid.h"
+#include "resource_manager.h"
+#include "random.h"
+
+// Represents the current state of the game
+enum GameState {
+    GAME_ACTIVE,
+    GAME_MENU,
+    GAME_WIN
+};
+
+// Represents the four possible (collision) directions
+enum Direction {
+    UP,
+    RIGHT,
+    DOWN,
+    LEFT
+};
+// Defines a Collision typedef that represents collision data
+typedef std::tuple<bool, Direction, glm::vec2> Collision; // <collision?, what direction?, difference vector center - closest point>
+
+// The keys held down during a simulation step; a bitmask of these is the simulation's only input
+enum GameInput {
+    INPUT_LEFT     = 1 << 0, // move the paddle left (A)
+    INPUT_RIGHT    = 1 << 1, // move the paddle right (D)
+    INPUT_LAUNCH   = 1 << 2, // release the ball (SPACE)
+    INPUT_CONFIRM  = 1 << 3, // start the game, or back to the menu after winning (ENTER)
+    INPUT_NEXT     = 1 << 4, // select the next level in the menu (W)
+    INPUT_PREVIOUS = 1 << 5  // select the previous level in the menu (S)
+};
+
+// Things that happened during a simulation step, for the front end to play sounds on
+enum GameEvent {
+    EVENT_BRICK_DESTROYED = 1 << 0,
+    EVENT_SOLID_HIT       = 1 << 1,
+    EVENT_PADDLE_HIT      = 1 << 2,
+    EVENT_POWERUP         = 1 << 3
+};
+
+// collision detection
+bool      CheckCollision(GameObject &one, GameObject &two);   // AABB - AABB collision
+Collision CheckCollision(BallObject &one, GameObject &two);   // AABB - Circle collision
+Direction VectorDirection(glm::vec2 closest);
+// moves the ball out of the object it collided with and reflects its velocity
+void      ResolveCollision(BallObject &ball, Collision collision);
+// swept Circle - AABB collision: the earliest time (as a fraction of delta) at which the ball, moving by delta, touches the object and the object's surface normal there
+bool      SweepCollision(BallObject &one, glm::vec2 delta, GameObject &two, float &time, glm::vec2 &normal);
+
+// Initial size of the player paddle
+const glm::vec2 PLAYER_SIZE(100.0f, 20.0f);
+// Initial velocity of the player paddle
+const float PLAYER_VELOCITY(500.0f);
+// Initial velocity of the Ball
+const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
+// Radius of the ball object
+const float BALL_RADIUS = 12.5f;
+
+// GameWorld holds the simulation of a game of Breakout: the levels,
+// paddle, ball, PowerUps and random number generator, without any
+// rendering or audio. It only advances in steps driven by a bitmask
+// of GameInput, so with the same seed and inputs it always ends up
+// in the same state; Hash() checks this. The Game front end renders
+// it and plays sounds for the GameEvents of each step.
+class GameWorld
+{
+public:
+    // game state
+    GameState               State;
+    unsigned int            Width, Height;
+    std::vector<GameLevel>  Levels;
+    std::vector<PowerUp>    PowerUps;
+    std::bitset<POWERUP_COUNT> ActivePowerUps; // types of PowerUp with an effect that's still active
+    unsigned int            Level;
+    unsigned int            Lives;
+    GameObject              Player;
+    BallObject              Ball;
+    Random                  RNG;
+    unsigned int            Tick; // number of steps simulated
+    // post-processing effects turned on by the game
+    bool                    Shake, Confuse, Chaos;
+    float                   ShakeTime;
+    // GameEvents of the last step
+    unsigned int            Events;
+    // constructor
+    GameWorld(unsigned int width, unsigned int height, std::uint64_t seed = 1);
+    // loads the levels and places the paddle and ball (textures are used if they're loaded, the simulation doesn't need them)
+    void Init(const std::vector<LevelTiles> &levels);
+    // advances the simulation by one step with the given GameInput bits held down
+    void Step(float dt, unsigned int input);
+    // hash of the whole simulation state, equal for equal states
+    std::uint64_t Hash() const;
+    // collisions
+    void MoveBall(float dt);
+    void DoCollisions();
+    void HitBrick(GameObject &brick);
+    void HitPaddle();
+    // reset
+    void ResetLevel();
+    void ResetPlayer();
+    // powerups
+    void SpawnPowerUps(GameObject &block);
+    void UpdatePowerUps(float dt);
+    void ActivatePowerUp(PowerUp &powerUp);
+private:
+    // sprite of each type of PowerUp, resolved in Init
+    TextureHandle             powerUpTextures[POWERUP_COUNT];
+    // input of the previous step, to tell new key presses from held keys
+    unsigned int              previousInput;
+    // broadphase for the PowerUps; they move, so the grid is refilled on every collision pass
+    UniformGrid               powerUpGrid;
+    std::vector<unsigned int> collisionCandidates;
+    // steps of the game loop
+    void processInput(float dt, unsigned int input);
+    void update(float dt);
+};
+
+#endif
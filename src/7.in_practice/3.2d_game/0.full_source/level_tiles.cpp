@@ -0,0 +1,133 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "level_tiles.h"
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+#include "random.h"
+
+
+// binary level file identification
+static const std::uint32_t LEVEL_FILE_MAGIC = 0x31564C42; // "BLV1"
+static const std::uint32_t LEVEL_FILE_VERSION = 1;
+
+LevelTiles::LevelTiles()
+    : Columns(0), Rows(0)
+{
+
+}
+
+bool LevelTiles::Load(const char *file)
+{
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream)
+        return false;
+    std::uint32_t header[4];
+    if (stream.read(reinterpret_cast<char*>(header), sizeof(header)) && header[0] == LEVEL_FILE_MAGIC)
+    {
+        if (header[1] != LEVEL_FILE_VERSION)
+            return false;
+        // levels can be of any size, but the tile codes must be exactly the rest of the file: checked before
+        // allocating, so a corrupt header can't make us allocate gigabytes
+        std::streampos codesStart = stream.tellg();
+        stream.seekg(0, std::ios::end);
+        std::streamoff remaining = stream.tellg() - codesStart;
+        stream.seekg(codesStart);
+        if (header[2] == 0 || header[3] == 0 || remaining != static_cast<std::streamoff>(header[2]) * static_cast<std::streamoff>(header[3]))
+            return false;
+        std::vector<std::uint8_t> codes(static_cast<size_t>(header[2]) * header[3]);
+        if (!stream.read(reinterpret_cast<char*>(codes.data()), codes.size()))
+            return false;
+        this->Columns = header[2];
+        this->Rows = header[3];
+        this->Codes.swap(codes);
+        return true;
+    }
+    // not a binary level: read it whole and parse it as text
+    stream.clear();
+    stream.seekg(0);
+    std::vector<char> text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    return this->parse(text);
+}
+
+bool LevelTiles::Save(const char *file) const
+{
+    // an empty level can't be loaded again
+    if (this->Columns == 0 || this->Rows == 0)
+        return false;
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream)
+        return false;
+    std::uint32_t header[4] = { LEVEL_FILE_MAGIC, LEVEL_FILE_VERSION, this->Columns, this->Rows };
+    stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(this->Codes.data()), this->Codes.size());
+    return static_cast<bool>(stream);
+}
+
+void LevelTiles::Generate(unsigned int columns, unsigned int rows, std::uint64_t seed, bool gaps)
+{
+    Random random(seed);
+    this->Columns = columns;
+    this->Rows = rows;
+    this->Codes.assign(columns * rows, 0);
+    // mirrored left to right like the hand made levels, with a color per band of rows;
+    // a few gaps and solid bricks are sprinkled in, denser further down
+    unsigned int bandHeight = std::max(1u, rows / 8);
+    unsigned int gapChance = gaps ? 10 : 0;
+    bool completable = false;
+    for (unsigned int y = 0; y < rows; ++y)
+    {
+        unsigned int color = 2 + (y / bandHeight + random.Range(2)) % 4;
+        unsigned int solidChance = 4 + 8 * y / rows;
+        for (unsigned int x = 0; x < (columns + 1) / 2; ++x)
+        {
+            unsigned int roll = random.Range(100);
+            unsigned int code = roll < gapChance ? 0 : roll < gapChance + solidChance ? 1 : color;
+            this->Codes[y * columns + x] = code;
+            this->Codes[y * columns + columns - 1 - x] = code;
+            completable |= code > 1;
+        }
+    }
+    // a level without destructible bricks would be won right away
+    if (!completable && columns > 0 && rows > 0)
+        this->Codes[(rows - 1) * columns + columns / 2] = 2;
+}
+
+bool LevelTiles::parse(const std::vector<char> &text)
+{
+    // one row per line; the first row sets the width, other rows are padded or cut to it
+    this->Columns = 0;
+    this->Rows = 0;
+    this->Codes.clear();
+    size_t rowStart = 0;
+    for (size_t i = 0; i <= text.size(); ++i)
+    {
+        if (i < text.size() && text[i] >= '0' && text[i] <= '9')
+        {
+            unsigned int code = 0;
+            for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+                code = std::min(code * 10 + (text[i] - '0'), 255u);
+            this->Codes.push_back(code);
+        }
+        if (i == text.size() || text[i] == '\n')
+        {
+            // skip blank lines
+            if (this->Codes.size() == rowStart)
+                continue;
+            if (this->Rows == 0)
+                this->Columns = this->Codes.size();
+            this->Codes.resize(rowStart + this->Columns, 0);
+            this->Rows++;
+            rowStart = this->Codes.size();
+        }
+    }
+    return this->Rows > 0;
+}
\ No newline at end of file
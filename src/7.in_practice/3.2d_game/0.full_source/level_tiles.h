@@ -0,0 +1,43 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef LEVEL_TILES_H
+#define LEVEL_TILES_H
+#include <vector>
+#include <cstdint>
+
+
+// LevelTiles holds the layout of a Breakout level: a tile code per
+// brick, row by row. 0 is empty, 1 a solid brick and 2-5 are bricks
+// of different colors. Levels are written as text (.lvl, one row of
+// space separated codes per line) or in a compact binary format that
+// loads with a single read; Load accepts both. Generate creates
+// random levels of any size from a seed.
+class LevelTiles
+{
+public:
+    // level layout
+    unsigned int               Columns, Rows;
+    std::vector<std::uint8_t>  Codes; // Columns * Rows tile codes
+    // constructor
+    LevelTiles();
+    // returns the tile code at the given column and row
+    unsigned int Get(unsigned int column, unsigned int row) const { return this->Codes[row * this->Columns + column]; }
+    // reads the level from a text or binary level file
+    bool Load(const char *file);
+    // writes the level to a binary level file
+    bool Save(const char *file) const;
+    // fills a columns x rows level with randomly placed (but always completable) bricks; equal seeds give equal levels.
+    // Without gaps every tile holds a brick
+    void Generate(unsigned int columns, unsigned int rows, std::uint64_t seed, bool gaps = true);
+private:
+    // parses a text level
+    bool parse(const std::vector<char> &text);
+};
+
+#endif
\ No newline at end of file
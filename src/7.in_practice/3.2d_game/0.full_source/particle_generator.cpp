@@ -8,59 +8,105 @@
 ******************************************************************/
 #include "particle_generator.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PARTICLES_USE_SSE
+#endif
+
+
+// target[i] -= source[i] * scale, 4 floats at a time where SSE is available
+static void subtractScaled(float *target, const float *source, float scale, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef PARTICLES_USE_SSE
+    __m128 scale4 = _mm_set1_ps(scale);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(target + i, _mm_sub_ps(_mm_loadu_ps(target + i), _mm_mul_ps(_mm_loadu_ps(source + i), scale4)));
+#endif
+    for (; i < count; ++i)
+        target[i] -= source[i] * scale;
+}
+
+// target[i] -= value, 4 floats at a time where SSE is available
+static void subtract(float *target, float value, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef PARTICLES_USE_SSE
+    __m128 value4 = _mm_set1_ps(value);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(target + i, _mm_sub_ps(_mm_loadu_ps(target + i), value4));
+#endif
+    for (; i < count; ++i)
+        target[i] -= value;
+}
+
 ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-    : shader(shader), texture(texture), amount(amount)
+    : amount(amount), liveCount(0), overwriteIndex(0), shader(shader), texture(texture)
 {
     this->init();
 }
 
+ParticleGenerator::~ParticleGenerator()
+{
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->quadVBO);
+    glDeleteBuffers(1, &this->positionVBO);
+    glDeleteBuffers(1, &this->colorVBO);
+    glDeleteBuffers(1, &this->alphaVBO);
+}
+
 void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset)
 {
+    // without any reserved particles there is nothing to spawn into (spawnIndex wraps around this->amount)
+    if (this->amount == 0)
+        return;
     // add new particles 
     for (unsigned int i = 0; i < newParticles; ++i)
-    {
-        int unusedParticle = this->firstUnusedParticle();
-        this->respawnParticle(this->particles[unusedParticle], object, offset);
-    }
-    // update all particles
-    for (unsigned int i = 0; i < this->amount; ++i)
-    {
-        Particle &p = this->particles[i];
-        p.Life -= dt; // reduce life
-        if (p.Life > 0.0f)
-        {	// particle is alive, thus update
-            p.Position -= p.Velocity * dt; 
-            p.Color.a -= dt * 2.5f;
-        }
-    }
+        this->respawnParticle(this->spawnIndex(), object, offset);
+    // update all live particles, one attribute at a time
+    subtract(this->lives.data(), dt, this->liveCount); // reduce life
+    subtractScaled(&this->positions[0].x, &this->velocities[0].x, dt, this->liveCount * 2);
+    subtract(this->alphas.data(), dt * 2.5f, this->liveCount);
+    // and keep the live ones together
+    this->compact();
 }
 
 // render all particles
 void ParticleGenerator::Draw()
 {
-    // use additive blending to give it a 'glow' effect
+    if (this->liveCount == 0)
+        return;
+    // stream the live particles into the instance buffers, orphaning them so we don't wait on last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, this->positionVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(glm::vec2), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->liveCount * sizeof(glm::vec2), this->positions.data());
+    glBindBuffer(GL_ARRAY_BUFFER, this->colorVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(glm::vec3), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->liveCount * sizeof(glm::vec3), this->colors.data());
+    glBindBuffer(GL_ARRAY_BUFFER, this->alphaVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->liveCount * sizeof(float), this->alphas.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // use additive blending to give it a 'glow' effect (which also makes the draw order irrelevant)
     glBlendFunc(GL_SRC_ALPHA, GL_ONE);
     this->shader.Use();
-    for (Particle particle : this->particles)
-    {
-        if (particle.Life > 0.0f)
-        {
-            this->shader.SetVector2f("offset", particle.Position);
-            this->shader.SetVector4f("color", particle.Color);
-            this->texture.Bind();
-            glBindVertexArray(this->VAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
-        }
-    }
+    glActiveTexture(GL_TEXTURE0);
+    this->texture.Bind();
+    glBindVertexArray(this->VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->liveCount);
+    glBindVertexArray(0);
     // don't forget to reset to default blending mode
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+unsigned int ParticleGenerator::LiveCount() const
+{
+    return this->liveCount;
+}
+
 void ParticleGenerator::init()
 {
     // set up mesh and attribute properties
-    unsigned int VBO;
     float particle_quad[] = {
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f,
@@ -71,50 +117,79 @@ void ParticleGenerator::init()
         1.0f, 0.0f, 1.0f, 0.0f
     }; 
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &this->quadVBO);
+    glGenBuffers(1, &this->positionVBO);
+    glGenBuffers(1, &this->colorVBO);
+    glGenBuffers(1, &this->alphaVBO);
     glBindVertexArray(this->VAO);
     // fill mesh buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
     // set mesh attributes
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    // set per-particle attributes, each streamed straight from its own array
+    glBindBuffer(GL_ARRAY_BUFFER, this->positionVBO);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, this->colorVBO);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glVertexAttribDivisor(2, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, this->alphaVBO);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+    glVertexAttribDivisor(3, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    // create this->amount default particle instances
-    for (unsigned int i = 0; i < this->amount; ++i)
-        this->particles.push_back(Particle());
+    // reserve storage for this->amount particles
+    this->positions.resize(this->amount);
+    this->velocities.resize(this->amount);
+    this->colors.resize(this->amount);
+    this->alphas.resize(this->amount);
+    this->lives.resize(this->amount);
 }
 
-// stores the index of the last particle used (for quick access to next dead particle)
-unsigned int lastUsedParticle = 0;
-unsigned int ParticleGenerator::firstUnusedParticle()
+unsigned int ParticleGenerator::spawnIndex()
 {
-    // first search from last used particle, this will usually return almost instantly
-    for (unsigned int i = lastUsedParticle; i < this->amount; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // otherwise, do a linear search
-    for (unsigned int i = 0; i < lastUsedParticle; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // all particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-    lastUsedParticle = 0;
-    return 0;
+    // dead particles are always behind the live ones, so a free particle is found without searching
+    if (this->liveCount < this->amount)
+        return this->liveCount++;
+    // all particles are taken, override the next one in turn (note that if it repeatedly hits this case, more particles should be reserved)
+    unsigned int index = this->overwriteIndex;
+    this->overwriteIndex = (this->overwriteIndex + 1) % this->amount;
+    return index;
 }
 
-void ParticleGenerator::respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset)
+void ParticleGenerator::respawnParticle(unsigned int index, GameObject &object, glm::vec2 offset)
 {
-    float random = ((rand() % 100) - 50) / 10.0f;
-    float rColor = 0.5f + ((rand() % 100) / 100.0f);
-    particle.Position = object.Position + random + offset;
-    particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
-    particle.Life = 1.0f;
-    particle.Velocity = object.Velocity * 0.1f;
-}
\ No newline at end of file
+    float random = (this->generator.Range(100) - 50.0f) / 10.0f;
+    float rColor = 0.5f + this->generator.Range(100) / 100.0f;
+    this->positions[index] = object.Position + random + offset;
+    this->colors[index] = glm::vec3(rColor);
+    this->alphas[index] = 1.0f;
+    this->lives[index] = 1.0f;
+    this->velocities[index] = object.Velocity * 0.1f;
+}
+
+void ParticleGenerator::compact()
+{
+    // swap-remove: the last live particle takes the place of each dead one (order doesn't matter with additive blending)
+    unsigned int i = 0;
+    while (i < this->liveCount)
+    {
+        if (this->lives[i] > 0.0f)
+        {
+            ++i;
+            continue;
+        }
+        unsigned int last = --this->liveCount;
+        this->positions[i] = this->positions[last];
+        this->velocities[i] = this->velocities[last];
+        this->colors[i] = this->colors[last];
+        this->alphas[i] = this->alphas[last];
+        this->lives[i] = this->lives[last];
+    }
+}
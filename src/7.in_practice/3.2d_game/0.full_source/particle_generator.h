@@ -16,44 +16,53 @@
 #include "shader.h"
 #include "texture.h"
 #include "game_object.h"
-
-
-// Represents a single particle and its state
-struct Particle {
-    glm::vec2 Position, Velocity;
-    glm::vec4 Color;
-    float     Life;
-
-    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
-};
+#include "random.h"
 
 
 // ParticleGenerator acts as a container for rendering a large number of 
 // particles by repeatedly spawning and updating particles and killing 
 // them after a given amount of time.
+// Particle state is stored as a structure of arrays with all live
+// particles packed at the front, so each update is a straight (SIMD)
+// loop over every attribute and all particles are rendered with a
+// single instanced draw call.
 class ParticleGenerator
 {
 public:
-    // constructor
+    // constructor/destructor
     ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount);
+    ~ParticleGenerator();
+    // no copies: the destructor deletes the VAO and instance buffers
+    ParticleGenerator(const ParticleGenerator&) = delete;
+    ParticleGenerator& operator=(const ParticleGenerator&) = delete;
     // update all particles
     void Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
     // render all particles
     void Draw();
+    // number of particles currently alive
+    unsigned int LiveCount() const;
 private:
-    // state
-    std::vector<Particle> particles;
+    // state, one entry per particle; only the first liveCount particles are alive
+    std::vector<glm::vec2> positions, velocities;
+    std::vector<glm::vec3> colors;
+    std::vector<float>     alphas, lives;
     unsigned int amount;
+    unsigned int liveCount;
+    unsigned int overwriteIndex; // next particle to replace when all of them are alive
+    Random       generator;      // particles are only visual, so they don't draw from (and disturb) the game's generator
     // render state
     Shader shader;
     Texture2D texture;
     unsigned int VAO;
+    unsigned int quadVBO, positionVBO, colorVBO, alphaVBO;
     // initializes buffer and vertex attributes
     void init();
-    // returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
-    unsigned int firstUnusedParticle();
+    // returns the index of the particle to spawn: a new one at the end of the live particles or, if all are alive, the next one in turn
+    unsigned int spawnIndex();
     // respawns particle
-    void respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    void respawnParticle(unsigned int index, GameObject &object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    // moves dead particles out of the live range, filling their slots with the last live particles
+    void compact();
 };
 
 #endif
\ No newline at end of file
@@ -8,8 +8,6 @@
 ******************************************************************/
 #ifndef POWER_UP_H
 #define POWER_UP_H
-#include <string>
-
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -21,21 +19,32 @@ const glm::vec2 POWERUP_SIZE(60.0f, 20.0f);
 // Velocity a PowerUp block has when spawned
 const glm::vec2 VELOCITY(0.0f, 150.0f);
 
+// Represents the types of PowerUp
+enum PowerUpType {
+    POWERUP_SPEED,
+    POWERUP_STICKY,
+    POWERUP_PASS_THROUGH,
+    POWERUP_PAD_SIZE_INCREASE,
+    POWERUP_CONFUSE,
+    POWERUP_CHAOS,
+    POWERUP_COUNT
+};
+
 
 // PowerUp inherits its state and rendering functions from
 // GameObject but also holds extra information to state its
 // active duration and whether it is activated or not. 
-// The type of PowerUp is stored as a string.
+// The type of PowerUp is stored as a PowerUpType.
 class PowerUp : public GameObject 
 {
 public:
     // powerup state
-    std::string Type;
+    PowerUpType Type;
     float       Duration;	
     bool        Activated;
     // constructor
-    PowerUp(std::string type, glm::vec3 color, float duration, glm::vec2 position, Texture2D texture) 
-        : GameObject(position, POWERUP_SIZE, texture, color, VELOCITY), Type(type), Duration(duration), Activated() { }
+    PowerUp(PowerUpType type, glm::vec3 color, float duration, glm::vec2 position, Texture2D texture, glm::vec4 textureRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)) 
+        : GameObject(position, POWERUP_SIZE, texture, color, VELOCITY), Type(type), Duration(duration), Activated() { this->SpriteRect = textureRect; }
 };
 
 #endif
\ No newline at end of file
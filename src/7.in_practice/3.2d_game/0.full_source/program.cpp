@@ -11,22 +11,59 @@
 
 #include "game.h"
 #include "resource_manager.h"
+#include "particle_generator.h"
+#include "replay.h"
 
 #include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+// measures the CPU cost of a million particles (run with --particle-benchmark)
+int particle_benchmark();
+// compares brute force and grid broadphase ball-brick collisions (run with --collision-benchmark)
+int collision_benchmark();
+// plays a recorded game back without a window, checking the state hash of every step (run with --replay <file>)
+int replay_game(const char *file);
+// simulates a game played by an autopilot without a window, as a benchmark of the game loop (run with --simulate <ticks> [level])
+int simulate_game(unsigned int ticks, unsigned int level);
+// converts a text level to a binary level (run with --convert-level <input> <output>)
+int convert_level(const char *input, const char *output);
+// writes a generated level to a binary level (run with --generate-level <columns> <rows> <seed> <output>)
+int generate_level(unsigned int columns, unsigned int rows, std::uint64_t seed, const char *output);
 
 // The Width of the screen
 const unsigned int SCREEN_WIDTH = 800;
 // The height of the screen
 const unsigned int SCREEN_HEIGHT = 600;
+// Duration of a simulation step: the game is simulated at a fixed rate, independent of the frame rate
+const float SIMULATION_STEP = 1.0f / 120.0f;
+// Longest frame time that is simulated; after longer hitches the game slows down instead of running a burst of steps
+const float MAX_FRAME_TIME = 0.25f;
+// Seed of the game's random number generator
+const std::uint64_t GAME_SEED = 1;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 int main(int argc, char *argv[])
 {
+    // the headless modes only run the simulation, they don't need a window
+    if (argc > 2 && std::strcmp(argv[1], "--replay") == 0)
+        return replay_game(argv[2]);
+    if (argc > 2 && std::strcmp(argv[1], "--simulate") == 0)
+        return simulate_game(std::atoi(argv[2]), argc > 3 ? std::atoi(argv[3]) : 0);
+    if (argc > 3 && std::strcmp(argv[1], "--convert-level") == 0)
+        return convert_level(argv[2], argv[3]);
+    if (argc > 5 && std::strcmp(argv[1], "--generate-level") == 0)
+        return generate_level(std::atoi(argv[2]), std::atoi(argv[3]), std::strtoull(argv[4], nullptr, 10), argv[5]);
+    // record the game when run with --record <file>
+    const char *recordFile = argc > 2 && std::strcmp(argv[1], "--record") == 0 ? argv[2] : nullptr;
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -56,14 +93,33 @@ int main(int argc, char *argv[])
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    if (argc > 1 && (std::strcmp(argv[1], "--particle-benchmark") == 0 || std::strcmp(argv[1], "--collision-benchmark") == 0))
+    {
+        int result = std::strcmp(argv[1], "--particle-benchmark") == 0 ? particle_benchmark() : collision_benchmark();
+        ResourceManager::Clear();
+        glfwTerminate();
+        return result;
+    }
+
     // initialize game
     // ---------------
+    Breakout.World.RNG.Seed(GAME_SEED);
     Breakout.Init();
+    Replay recording;
+    if (recordFile)
+    {
+        recording.Seed = GAME_SEED;
+        recording.Width = SCREEN_WIDTH;
+        recording.Height = SCREEN_HEIGHT;
+        recording.StepTime = SIMULATION_STEP;
+        Breakout.Recording = &recording;
+    }
 
     // deltaTime variables
     // -------------------
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
+    float accumulator = 0.0f; // frame time not simulated yet
 
     while (!glfwWindowShouldClose(window))
     {
@@ -74,23 +130,27 @@ int main(int argc, char *argv[])
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        // manage user input
-        // -----------------
-        Breakout.ProcessInput(deltaTime);
-
-        // update game state
-        // -----------------
-        Breakout.Update(deltaTime);
+        // manage user input and update game state in fixed steps
+        // ------------------------------------------------------
+        accumulator += std::min(deltaTime, MAX_FRAME_TIME);
+        while (accumulator >= SIMULATION_STEP)
+        {
+            Breakout.Step(SIMULATION_STEP);
+            accumulator -= SIMULATION_STEP;
+        }
 
-        // render
-        // ------
+        // render, interpolating between the last two steps by the part of a step left over
+        // --------------------------------------------------------------------------------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        Breakout.Render();
+        Breakout.Render(accumulator / SIMULATION_STEP);
 
         glfwSwapBuffers(window);
     }
 
+    if (recordFile && !recording.Save(recordFile))
+        std::cout << "Failed to write replay " << recordFile << std::endl;
+
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
     ResourceManager::Clear();
@@ -121,4 +181,190 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     // make sure the viewport matches the new window dimensions; note that width and 
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
+}
+
+int particle_benchmark()
+{
+    const unsigned int PARTICLE_COUNT = 1000000;
+    const unsigned int FRAME_COUNT = 300;
+    const float dt = 1.0f / 60.0f;
+    // particles live for a second, so spawning PARTICLE_COUNT * dt per frame keeps (almost) all of them alive
+    const unsigned int newParticles = static_cast<unsigned int>(PARTICLE_COUNT * dt);
+
+    Shader shader = ResourceManager::LoadShader("particle.vs", "particle.fs", nullptr, "particle");
+    ParticleGenerator particles(shader, Texture2D(), PARTICLE_COUNT);
+    GameObject emitter(glm::vec2(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f), glm::vec2(10.0f), Texture2D(), glm::vec3(1.0f), glm::vec2(100.0f, -350.0f));
+    // warm up until the number of live particles is steady
+    for (unsigned int frame = 0; frame < 120; ++frame)
+        particles.Update(dt, emitter, newParticles);
+
+    double updateTime = 0.0, drawTime = 0.0;
+    unsigned int liveCount = 0;
+    for (unsigned int frame = 0; frame < FRAME_COUNT; ++frame)
+    {
+        double start = glfwGetTime();
+        particles.Update(dt, emitter, newParticles);
+        double updated = glfwGetTime();
+        particles.Draw();
+        drawTime += glfwGetTime() - updated;
+        updateTime += updated - start;
+        liveCount += particles.LiveCount();
+    }
+    glFinish();
+    std::cout << "particles:   " << liveCount / FRAME_COUNT << " live on average" << std::endl;
+    std::cout << "update:      " << updateTime * 1000.0 / FRAME_COUNT << " ms per frame" << std::endl;
+    std::cout << "draw (CPU):  " << drawTime * 1000.0 / FRAME_COUNT << " ms per frame" << std::endl;
+    return 0;
+}
+
+int collision_benchmark()
+{
+    const unsigned int COLUMNS = 200, ROWS = 100;
+    const unsigned int BALL_COUNT = 100;
+    const unsigned int FRAME_COUNT = 300;
+    const unsigned int WORLD_WIDTH = 8000, WORLD_HEIGHT = 4000;
+    const float dt = 1.0f / 60.0f;
+    // a generated level of bricks of 40x20 pixels (larger than the ball, as in the game) in the top half of the world
+    LevelTiles tiles;
+    tiles.Generate(COLUMNS, ROWS, 1);
+
+    for (int useGrid = 0; useGrid < 2; ++useGrid)
+    {
+        // both passes simulate exactly the same balls
+        GameLevel level;
+        level.Load(tiles, WORLD_WIDTH, WORLD_HEIGHT / 2);
+        std::vector<BallObject> balls;
+        Random random(1);
+        for (unsigned int i = 0; i < BALL_COUNT; ++i)
+        {
+            glm::vec2 position(random.Range(WORLD_WIDTH - 25), WORLD_HEIGHT / 2 + random.Range(WORLD_HEIGHT / 8)); // just below the bricks
+            float angle = random.Range(360) * 3.14159265f / 180.0f;
+            balls.push_back(BallObject(position, BALL_RADIUS, glm::vec2(std::cos(angle), std::sin(angle)) * 500.0f, Texture2D()));
+            balls.back().Stuck = false;
+        }
+
+        std::vector<unsigned int> candidates;
+        unsigned int collisions = 0, tests = 0;
+        double start = glfwGetTime();
+        for (unsigned int frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            for (BallObject &ball : balls)
+            {
+                ball.Move(dt, WORLD_WIDTH);
+                if (ball.Position.y + ball.Size.y >= WORLD_HEIGHT) // the benchmark has no bottom edge to lose balls on
+                {
+                    ball.Velocity.y = -ball.Velocity.y;
+                    ball.Position.y = WORLD_HEIGHT - ball.Size.y;
+                }
+                // same processing order in both passes: bricks by increasing index
+                if (useGrid)
+                    level.BrickGrid.Query(ball.Position - ball.Radius, glm::vec2(ball.Radius * 4.0f), candidates);
+                unsigned int candidateCount = useGrid ? candidates.size() : level.Bricks.size();
+                for (unsigned int i = 0; i < candidateCount; ++i)
+                {
+                    GameObject &box = level.Bricks[useGrid ? candidates[i] : i];
+                    if (box.Destroyed)
+                        continue;
+                    ++tests;
+                    Collision collision = CheckCollision(ball, box);
+                    if (std::get<0>(collision))
+                    {
+                        ++collisions;
+                        if (!box.IsSolid)
+                            box.Destroyed = true;
+                        ResolveCollision(ball, collision);
+                    }
+                }
+            }
+        }
+        double elapsed = glfwGetTime() - start;
+        std::cout << (useGrid ? "uniform grid: " : "brute force:  ") << elapsed * 1000.0 / FRAME_COUNT << " ms per frame, "
+                  << tests / FRAME_COUNT << " tests per frame, " << collisions << " collisions" << std::endl;
+    }
+    return 0;
+}
+
+int replay_game(const char *file)
+{
+    Replay replay;
+    if (!replay.Load(file))
+    {
+        std::cout << "Failed to read replay " << file << std::endl;
+        return -1;
+    }
+    GameWorld world(replay.Width, replay.Height, replay.Seed);
+    world.Init(Game::LoadLevels());
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int tick = 0; tick < replay.Inputs.size(); ++tick)
+    {
+        world.Step(replay.StepTime, replay.Inputs[tick]);
+        if (world.Hash() != replay.Hashes[tick])
+        {
+            std::cout << "replay diverged at tick " << tick << std::endl;
+            return 1;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "replayed " << replay.Inputs.size() << " ticks identically in " << elapsed * 1000.0 << " ms ("
+              << replay.Inputs.size() / elapsed << " ticks per second, hashing included)" << std::endl;
+    return 0;
+}
+
+int simulate_game(unsigned int ticks, unsigned int level)
+{
+    GameWorld world(SCREEN_WIDTH, SCREEN_HEIGHT, GAME_SEED);
+    world.Init(Game::LoadLevels());
+    world.Level = level % world.Levels.size();
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int tick = 0; tick < ticks; ++tick)
+    {
+        // autopilot: keep (re)starting the game and launching the ball, and follow the ball with the paddle
+        unsigned int input = INPUT_LAUNCH;
+        if (tick % 2 == 0) // confirming only reacts to new presses
+            input |= INPUT_CONFIRM;
+        float ballCenter = world.Ball.Position.x + world.Ball.Radius;
+        float paddleCenter = world.Player.Position.x + world.Player.Size.x / 2.0f;
+        if (ballCenter < paddleCenter - 10.0f)
+            input |= INPUT_LEFT;
+        else if (ballCenter > paddleCenter + 10.0f)
+            input |= INPUT_RIGHT;
+        world.Step(SIMULATION_STEP, input);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    unsigned int destroyed = 0;
+    for (GameObject &brick : world.Levels[world.Level].Bricks)
+        destroyed += brick.Destroyed;
+    std::cout << ticks << " ticks in " << elapsed * 1000.0 << " ms (" << ticks / elapsed << " ticks per second), "
+              << destroyed << " bricks destroyed, state hash " << std::hex << world.Hash() << std::dec << std::endl;
+    return 0;
+}
+
+int convert_level(const char *input, const char *output)
+{
+    LevelTiles tiles;
+    if (!tiles.Load(input))
+    {
+        std::cout << "Failed to read level " << input << std::endl;
+        return -1;
+    }
+    if (!tiles.Save(output))
+    {
+        std::cout << "Failed to write level " << output << std::endl;
+        return -1;
+    }
+    std::cout << "converted " << tiles.Columns << "x" << tiles.Rows << " level to " << output << std::endl;
+    return 0;
+}
+
+int generate_level(unsigned int columns, unsigned int rows, std::uint64_t seed, const char *output)
+{
+    LevelTiles tiles;
+    tiles.Generate(columns, rows, seed);
+    if (!tiles.Save(output))
+    {
+        std::cout << "Failed to write level " << output << std::endl;
+        return -1;
+    }
+    std::cout << "generated " << columns << "x" << rows << " level " << output << std::endl;
+    return 0;
 }
\ No newline at end of file
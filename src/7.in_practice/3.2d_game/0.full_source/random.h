@@ -0,0 +1,46 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <cstdint>
+
+
+// Random is a small pseudo random number generator (xorshift64*).
+// Unlike rand() each game owns its own generator, so a game seeded
+// with the same number always plays out the same way. Its whole
+// state is a single number that can be hashed or saved.
+class Random
+{
+public:
+    // generator state, never 0
+    std::uint64_t State;
+    // constructor
+    Random(std::uint64_t seed = 1) { this->Seed(seed); }
+    // restarts the sequence; the seed is scrambled (splitmix64) so nearby seeds give unrelated sequences
+    void Seed(std::uint64_t seed)
+    {
+        std::uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z = z ^ (z >> 31);
+        this->State = z != 0 ? z : 1;
+    }
+    // returns the next 32 random bits
+    std::uint32_t Next()
+    {
+        this->State ^= this->State >> 12;
+        this->State ^= this->State << 25;
+        this->State ^= this->State >> 27;
+        return static_cast<std::uint32_t>((this->State * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+    // returns a random number in [0, range)
+    unsigned int Range(unsigned int range) { return this->Next() % range; }
+};
+
+#endif
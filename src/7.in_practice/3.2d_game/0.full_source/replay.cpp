@@ -0,0 +1,68 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "replay.h"
+
+#include <fstream>
+
+
+// file identification; bump the version whenever the layout or the simulation changes (old replays won't match anymore)
+static const std::uint32_t REPLAY_FILE_MAGIC = 0x31505242; // "BRP1"
+static const std::uint32_t REPLAY_FILE_VERSION = 5;
+
+Replay::Replay()
+    : Seed(1), Width(0), Height(0), StepTime(0.0f)
+{
+
+}
+
+bool Replay::Save(const char *file) const
+{
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream)
+        return false;
+    std::uint32_t header[5] = { REPLAY_FILE_MAGIC, REPLAY_FILE_VERSION, this->Width, this->Height, static_cast<std::uint32_t>(this->Inputs.size()) };
+    stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(&this->StepTime), sizeof(this->StepTime));
+    stream.write(reinterpret_cast<const char*>(&this->Seed), sizeof(this->Seed));
+    stream.write(reinterpret_cast<const char*>(this->Inputs.data()), this->Inputs.size());
+    stream.write(reinterpret_cast<const char*>(this->Hashes.data()), this->Hashes.size() * sizeof(std::uint64_t));
+    return static_cast<bool>(stream);
+}
+
+bool Replay::Load(const char *file)
+{
+    std::ifstream stream(file, std::ios::binary);
+    std::uint32_t header[5];
+    float stepTime;
+    std::uint64_t seed;
+    if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)) || !stream.read(reinterpret_cast<char*>(&stepTime), sizeof(stepTime))
+        || !stream.read(reinterpret_cast<char*>(&seed), sizeof(seed)))
+        return false;
+    if (header[0] != REPLAY_FILE_MAGIC || header[1] != REPLAY_FILE_VERSION)
+        return false;
+    // every step takes an input byte and a hash, check the step count against the rest of the file before allocating
+    std::streampos stepsStart = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    std::streamoff remaining = stream.tellg() - stepsStart;
+    stream.seekg(stepsStart);
+    if (remaining != static_cast<std::streamoff>(header[4]) * static_cast<std::streamoff>(sizeof(std::uint8_t) + sizeof(std::uint64_t)))
+        return false;
+    std::vector<std::uint8_t> inputs(header[4]);
+    std::vector<std::uint64_t> hashes(header[4]);
+    if (!stream.read(reinterpret_cast<char*>(inputs.data()), inputs.size())
+        || !stream.read(reinterpret_cast<char*>(hashes.data()), hashes.size() * sizeof(std::uint64_t)))
+        return false;
+    this->Width = header[2];
+    this->Height = header[3];
+    this->StepTime = stepTime;
+    this->Seed = seed;
+    this->Inputs.swap(inputs);
+    this->Hashes.swap(hashes);
+    return true;
+}
@@ -0,0 +1,37 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef REPLAY_H
+#define REPLAY_H
+#include <vector>
+#include <cstdint>
+
+
+// Replay records the input of every step of a simulated game
+// together with the hash of the game's state after that step.
+// Playing the inputs back through a GameWorld with the same seed
+// must reproduce every hash; the first step that doesn't points
+// at nondeterminism in the simulation.
+class Replay
+{
+public:
+    // game setup
+    std::uint64_t              Seed;
+    unsigned int               Width, Height;
+    float                      StepTime; // duration of a simulation step
+    // recorded steps
+    std::vector<std::uint8_t>  Inputs; // GameInput bits of each step
+    std::vector<std::uint64_t> Hashes; // GameWorld::Hash() after each step
+    // constructor
+    Replay();
+    // writes/reads the replay to/from a binary file
+    bool Save(const char *file) const;
+    bool Load(const char *file);
+};
+
+#endif
@@ -11,44 +11,123 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <set>
 
 #include "stb_image.h"
+#include "texture_atlas.h"
 
 // Instantiate static variables
-std::map<std::string, Texture2D>    ResourceManager::Textures;
-std::map<std::string, Shader>       ResourceManager::Shaders;
+std::deque<Texture2D>                ResourceManager::Textures;
+std::deque<Shader>                   ResourceManager::Shaders;
+std::deque<glm::vec4>                ResourceManager::TextureRects;
+std::map<std::string, ShaderHandle>  ResourceManager::shaderHandles;
+std::map<std::string, TextureHandle> ResourceManager::textureHandles;
 
 
-Shader ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
+Shader &ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
 {
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return Shaders[name];
+    Shader &shader = Shaders[GetShaderHandle(name)];
+    shader = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+    return shader;
+}
+
+Texture2D &ResourceManager::LoadTexture(const char *file, bool alpha, std::string name)
+{
+    TextureHandle handle = GetTextureHandle(name);
+    Textures[handle] = loadTextureFromFile(file, alpha);
+    TextureRects[handle] = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    return Textures[handle];
 }
 
-Shader ResourceManager::GetShader(std::string name)
+ShaderHandle ResourceManager::GetShaderHandle(std::string name)
 {
-    return Shaders[name];
+    auto iter = shaderHandles.find(name);
+    if (iter != shaderHandles.end())
+        return iter->second;
+    Shaders.push_back(Shader());
+    return shaderHandles[name] = Shaders.size() - 1;
 }
 
-Texture2D ResourceManager::LoadTexture(const char *file, bool alpha, std::string name)
+TextureHandle ResourceManager::GetTextureHandle(std::string name)
 {
-    Textures[name] = loadTextureFromFile(file, alpha);
-    return Textures[name];
+    auto iter = textureHandles.find(name);
+    if (iter != textureHandles.end())
+        return iter->second;
+    Textures.push_back(Texture2D());
+    TextureRects.push_back(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    return textureHandles[name] = Textures.size() - 1;
 }
 
-Texture2D ResourceManager::GetTexture(std::string name)
+Shader &ResourceManager::GetShader(std::string name)
 {
-    return Textures[name];
+    return Shaders[GetShaderHandle(name)];
+}
+
+Texture2D &ResourceManager::GetTexture(std::string name)
+{
+    return Textures[GetTextureHandle(name)];
+}
+
+glm::vec4 ResourceManager::GetTextureRect(std::string name)
+{
+    return TextureRects[GetTextureHandle(name)];
+}
+
+Texture2D &ResourceManager::LoadTextureAtlas(const std::vector<std::pair<std::string, std::string>> &images, const char *cacheFile, std::string name)
+{
+    // identify the source images by their names and file contents (FNV-1a), decoding them is what the cache saves
+    std::uint64_t key = 14695981039346656037ULL;
+    for (const auto &image : images)
+    {
+        std::ifstream file(image.second, std::ios::binary);
+        std::string bytes = image.first + '\0' + std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        for (unsigned char byte : bytes)
+            key = (key ^ byte) * 1099511628211ULL;
+    }
+    TextureAtlas atlas;
+    if (!atlas.Load(cacheFile, key))
+    {
+        for (const auto &image : images)
+        {
+            int width, height, nrChannels;
+            unsigned char* data = stbi_load(image.second.c_str(), &width, &height, &nrChannels, 4); // always pack as RGBA
+            if (!data)
+            {
+                std::cout << "ERROR::TEXTURE_ATLAS: Failed to load " << image.second << std::endl;
+                continue;
+            }
+            atlas.Add(image.first, width, height, data);
+            stbi_image_free(data);
+        }
+        if (!atlas.Pack())
+            std::cout << "ERROR::TEXTURE_ATLAS: Images don't fit in the atlas" << std::endl;
+        else if (!atlas.Save(cacheFile, key))
+            std::cout << "ERROR::TEXTURE_ATLAS: Failed to write " << cacheFile << std::endl;
+    }
+    Texture2D texture = atlas.Generate();
+    for (const auto &region : atlas.Regions)
+    {
+        TextureHandle handle = GetTextureHandle(region.first);
+        Textures[handle] = texture;
+        TextureRects[handle] = region.second;
+    }
+    TextureHandle handle = GetTextureHandle(name);
+    Textures[handle] = texture;
+    TextureRects[handle] = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    return Textures[handle];
 }
 
 void ResourceManager::Clear()
 {
     // (properly) delete all shaders	
-    for (auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
-    // (properly) delete all textures
-    for (auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+    for (const Shader &shader : Shaders)
+        glDeleteProgram(shader.ID);
+    // (properly) delete all textures; textures packed in an atlas share its ID
+    std::set<unsigned int> textureIDs;
+    for (const Texture2D &texture : Textures)
+        textureIDs.insert(texture.ID);
+    for (unsigned int ID : textureIDs)
+        glDeleteTextures(1, &ID);
 }
 
 Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
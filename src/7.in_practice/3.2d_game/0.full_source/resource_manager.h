@@ -10,36 +10,61 @@
 #define RESOURCE_MANAGER_H
 
 #include <map>
+#include <deque>
 #include <string>
+#include <vector>
+#include <utility>
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
 #include "texture.h"
 #include "shader.h"
 
 
+// Small integer handles of stored resources: their index in the
+// resource storage. Resolve them once by name (e.g. at init) and
+// use them on the per-frame path, which then does no string
+// operations or map lookups.
+typedef unsigned int ShaderHandle;
+typedef unsigned int TextureHandle;
+
 // A static singleton ResourceManager class that hosts several
 // functions to load Textures and Shaders. Each loaded texture
 // and/or shader is also stored for future reference by string
-// handles. All functions and resources are static and no 
-// public constructor is defined.
+// names and integer handles. All functions and resources are
+// static and no public constructor is defined.
 class ResourceManager
 {
 public:
-    // resource storage
-    static std::map<std::string, Shader>    Shaders;
-    static std::map<std::string, Texture2D> Textures;
+    // resource storage, indexed by handle; deques, so references stay valid when more resources are added
+    static std::deque<Shader>    Shaders;
+    static std::deque<Texture2D> Textures;
+    static std::deque<glm::vec4> TextureRects; // sub-rectangle <offset, size> of each texture, the whole texture unless it was packed in an atlas
     // loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
-    static Shader    LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
-    // retrieves a stored sader
-    static Shader    GetShader(std::string name);
+    static Shader    &LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
     // loads (and generates) a texture from file
-    static Texture2D LoadTexture(const char *file, bool alpha, std::string name);
-    // retrieves a stored texture
-    static Texture2D GetTexture(std::string name);
+    static Texture2D &LoadTexture(const char *file, bool alpha, std::string name);
+    // packs the given <name, file> images into a single atlas texture, or loads it from cacheFile if it was packed from the same images.
+    // Each image is stored by its own name, sharing the atlas texture; GetTextureRect gives its sub-rectangle
+    static Texture2D &LoadTextureAtlas(const std::vector<std::pair<std::string, std::string>> &images, const char *cacheFile, std::string name);
+    // resolves the handle of a name; names that aren't loaded (yet) get an empty resource, which loading under that name fills in
+    static ShaderHandle  GetShaderHandle(std::string name);
+    static TextureHandle GetTextureHandle(std::string name);
+    // retrieves a stored resource by handle
+    static Shader    &GetShader(ShaderHandle handle) { return Shaders[handle]; }
+    static Texture2D &GetTexture(TextureHandle handle) { return Textures[handle]; }
+    static glm::vec4  GetTextureRect(TextureHandle handle) { return TextureRects[handle]; }
+    // retrieves a stored resource by name (a string lookup: resolve a handle instead on the per-frame path)
+    static Shader    &GetShader(std::string name);
+    static Texture2D &GetTexture(std::string name);
+    static glm::vec4  GetTextureRect(std::string name);
     // properly de-allocates all loaded resources
     static void      Clear();
 private:
+    // handle of each name
+    static std::map<std::string, ShaderHandle>  shaderHandles;
+    static std::map<std::string, TextureHandle> textureHandles;
     // private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
     ResourceManager() { }
     // loads and generates a shader from file
@@ -25,7 +25,7 @@ public:
     // state
     unsigned int ID; 
     // constructor
-    Shader() { }
+    Shader() : ID(0) { }
     // sets the current shader as active
     Shader  &Use();
     // compiles the shader from given source code
@@ -6,9 +6,10 @@ out vec2 TexCoords;
 uniform mat4 model;
 // note that we're omitting the view matrix; the view never changes so we basically have an identity view matrix and can therefore omit it.
 uniform mat4 projection;
+uniform vec4 uvRect; // part of the texture to render: <vec2 offset, vec2 size>
 
 void main()
 {
-    TexCoords = vertex.zw;
+    TexCoords = uvRect.xy + vertex.zw * uvRect.zw;
     gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
 }
\ No newline at end of file
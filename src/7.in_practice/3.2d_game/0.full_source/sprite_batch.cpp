@@ -0,0 +1,140 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "sprite_batch.h"
+
+#include <algorithm>
+#include <cstddef>
+
+
+SpriteBatch::SpriteBatch(Shader shader)
+    : DrawCalls(0), SpriteCount(0), instanceCapacity(0), sortMode(SORT_DEFERRED)
+{
+    this->shader = shader;
+    this->initRenderData();
+}
+
+SpriteBatch::~SpriteBatch()
+{
+    glDeleteVertexArrays(1, &this->quadVAO);
+    glDeleteBuffers(1, &this->quadVBO);
+    glDeleteBuffers(1, &this->instanceVBO);
+}
+
+void SpriteBatch::Begin(SpriteSortMode sortMode)
+{
+    this->sortMode = sortMode;
+    this->instances.clear();
+    this->sortKeys.clear();
+}
+
+void SpriteBatch::DrawSprite(const Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec4 uvRect)
+{
+    SpriteInstance instance;
+    instance.PositionSize = glm::vec4(position, size);
+    instance.UVRect = uvRect;
+    instance.ColorRotate = glm::vec4(color, glm::radians(rotate)); // rotation is applied around the sprite's center in the vertex shader
+    // the submission index keeps the sort stable, so sprites sharing a texture keep their relative order
+    this->sortKeys.push_back(static_cast<std::uint64_t>(texture.ID) << 32 | this->instances.size());
+    this->instances.push_back(instance);
+}
+
+void SpriteBatch::End()
+{
+    unsigned int count = this->instances.size();
+    if (count == 0)
+        return;
+    // order the sprites: in deferred mode they're uploaded as is, otherwise grouped by texture
+    const SpriteInstance *data = this->instances.data();
+    if (this->sortMode == SORT_TEXTURE)
+    {
+        std::sort(this->sortKeys.begin(), this->sortKeys.end());
+        this->uploadData.resize(count);
+        for (unsigned int i = 0; i < count; ++i)
+            this->uploadData[i] = this->instances[this->sortKeys[i] & 0xFFFFFFFF];
+        data = this->uploadData.data();
+    }
+    // upload all sprites at once; orphaning the buffer lets the driver hand out fresh storage
+    // instead of waiting for the draw calls of the previous batch that still read from it
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    if (count > this->instanceCapacity)
+        this->instanceCapacity = std::max(count, this->instanceCapacity * 2);
+    glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(SpriteInstance), data);
+    // render each run of sprites sharing a texture with a single instanced draw call
+    this->shader.Use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(this->quadVAO);
+    unsigned int first = 0;
+    for (unsigned int i = 1; i <= count; ++i)
+    {
+        unsigned int texture = this->sortKeys[first] >> 32;
+        if (i < count && (this->sortKeys[i] >> 32) == texture)
+            continue;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        this->setInstanceOffset(first);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, i - first);
+        this->DrawCalls++;
+        first = i;
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    this->SpriteCount += count;
+    this->instances.clear();
+    this->sortKeys.clear();
+}
+
+void SpriteBatch::ResetStats()
+{
+    this->DrawCalls = 0;
+    this->SpriteCount = 0;
+}
+
+void SpriteBatch::initRenderData()
+{
+    // configure the shared quad, same layout as SpriteRenderer's
+    float vertices[] = {
+        // pos      // tex
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f
+    };
+
+    glGenVertexArrays(1, &this->quadVAO);
+    glGenBuffers(1, &this->quadVBO);
+    glGenBuffers(1, &this->instanceVBO);
+
+    glBindVertexArray(this->quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    // per-sprite attributes advance once per instance
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    for (unsigned int attribute = 1; attribute <= 3; ++attribute)
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    this->setInstanceOffset(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void SpriteBatch::setInstanceOffset(unsigned int first)
+{
+    // GL 3.3 has no base instance for instanced draws, so each run re-points the attributes instead
+    size_t offset = first * sizeof(SpriteInstance);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, PositionSize)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, UVRect)));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, ColorRotate)));
+}
@@ -0,0 +1,78 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+#include <vector>
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+#include "shader.h"
+
+
+// Defines in which order the sprites of a batch are drawn
+enum SpriteSortMode {
+    SORT_DEFERRED, // in submission order; consecutive sprites sharing a texture are merged into one draw call
+    SORT_TEXTURE   // grouped by texture (one draw call per texture); only use for sprites that don't overlap
+};
+
+// Per-sprite data as stored in the streaming instance buffer
+struct SpriteInstance {
+    glm::vec4 PositionSize; // <vec2 position, vec2 size>
+    glm::vec4 UVRect;       // <vec2 uv offset, vec2 uv size>
+    glm::vec4 ColorRotate;  // <vec3 color, float rotation in radians>
+};
+
+
+// SpriteBatch collects all sprites drawn between Begin() and End() and
+// renders them with as few instanced draw calls as possible. DrawSprite
+// only records the sprite, so it can be used as a drop-in replacement for
+// SpriteRenderer::DrawSprite. End() uploads all sprites into a single
+// streaming buffer and issues one draw call per run of equal textures.
+class SpriteBatch
+{
+public:
+    // statistics, accumulated until ResetStats() is called
+    unsigned int DrawCalls;
+    unsigned int SpriteCount;
+    // constructor (inits shaders/buffers)
+    SpriteBatch(Shader shader);
+    // destructor
+    ~SpriteBatch();
+    // owns its VAO and buffers, so it can't be copied
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+    // starts collecting sprites
+    void Begin(SpriteSortMode sortMode = SORT_DEFERRED);
+    // records a sprite, optionally rendering only part of the texture (uvRect = <offset, size> in texture coordinates)
+    void DrawSprite(const Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f), glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    // sorts, uploads and renders all sprites recorded since Begin()
+    void End();
+    // resets the DrawCalls and SpriteCount statistics
+    void ResetStats();
+private:
+    // render state
+    Shader       shader;
+    unsigned int quadVAO;
+    unsigned int quadVBO, instanceVBO;
+    unsigned int instanceCapacity; // number of sprites instanceVBO can hold
+    // batch state
+    SpriteSortMode              sortMode;
+    std::vector<SpriteInstance> instances;
+    std::vector<std::uint64_t>  sortKeys;  // <texture ID, submission index> of each recorded sprite, sorted in SORT_TEXTURE mode
+    std::vector<SpriteInstance> uploadData;
+    // initializes and configures the quad's buffer and the instance attributes
+    void initRenderData();
+    // points the instance attributes at the sprite with the given index in instanceVBO
+    void setInstanceOffset(unsigned int first);
+};
+
+#endif
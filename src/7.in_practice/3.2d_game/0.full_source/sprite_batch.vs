@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec4 vertex;       // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 positionSize; // per sprite: <vec2 position, vec2 size>
+layout (location = 2) in vec4 uvRect;       // per sprite: <vec2 uv offset, vec2 uv size>
+layout (location = 3) in vec4 colorRotate;  // per sprite: <vec3 color, float rotation>
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = uvRect.xy + vertex.zw * uvRect.zw;
+    SpriteColor = colorRotate.rgb;
+    // scale, then rotate around the center of the quad, then translate (same transform as sprite.vs' model matrix)
+    vec2 halfSize = 0.5 * positionSize.zw;
+    vec2 local = vertex.xy * positionSize.zw - halfSize;
+    float s = sin(colorRotate.w);
+    float c = cos(colorRotate.w);
+    vec2 rotated = vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+    gl_Position = projection * vec4(positionSize.xy + halfSize + rotated, 0.0, 1.0);
+}
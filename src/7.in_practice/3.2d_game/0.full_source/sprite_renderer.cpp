@@ -10,6 +10,7 @@
 
 
 SpriteRenderer::SpriteRenderer(Shader &shader)
+    : DrawCalls(0)
 {
     this->shader = shader;
     this->initRenderData();
@@ -20,7 +21,7 @@ SpriteRenderer::~SpriteRenderer()
     glDeleteVertexArrays(1, &this->quadVAO);
 }
 
-void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, glm::vec4 uvRect)
 {
     // prepare transformations
     this->shader.Use();
@@ -37,6 +38,7 @@ void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec
 
     // render textured quad
     this->shader.SetVector3f("spriteColor", color);
+    this->shader.SetVector4f("uvRect", uvRect);
 
     glActiveTexture(GL_TEXTURE0);
     texture.Bind();
@@ -44,6 +46,7 @@ void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec
     glBindVertexArray(this->quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
+    this->DrawCalls++;
 }
 
 void SpriteRenderer::initRenderData()
@@ -20,12 +20,14 @@
 class SpriteRenderer
 {
 public:
+    // number of draw calls issued, until reset by the user
+    unsigned int DrawCalls;
     // Constructor (inits shaders/shapes)
     SpriteRenderer(Shader &shader);
     // Destructor
     ~SpriteRenderer();
-    // Renders a defined quad textured with given sprite
-    void DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Renders a defined quad textured with given sprite, optionally only part of it (uvRect = <offset, size> in texture coordinates)
+    void DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f), glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
 private:
     // Render state
     Shader       shader; 
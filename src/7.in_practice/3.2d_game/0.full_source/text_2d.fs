@@ -1,12 +1,15 @@
 #version 330 core
 in vec2 TexCoords;
+in vec3 TextColor;
 out vec4 color;
 
 uniform sampler2D text;
-uniform vec3 textColor;
 
 void main()
 {    
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-    color = vec4(textColor, 1.0) * sampled;
-}  
\ No newline at end of file
+    // the atlas holds the distance to the glyph outline (0.5 on it), antialiased over about a pixel at any scale
+    float distance = texture(text, TexCoords).r;
+    float smoothing = 0.5 * fwidth(distance);
+    vec4 sampled = vec4(1.0, 1.0, 1.0, smoothstep(0.5 - smoothing, 0.5 + smoothing, distance));
+    color = vec4(TextColor, 1.0) * sampled;
+}
\ No newline at end of file
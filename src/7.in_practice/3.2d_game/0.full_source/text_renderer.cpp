@@ -7,134 +7,188 @@
 ** option) any later version.
 ******************************************************************/
 #include <iostream>
+#include <algorithm>
+#include <cstddef>
 
 #include <glm/gtc/matrix_transform.hpp>
-#include <ft2build.h>
-#include FT_FREETYPE_H
+#include <learnopengl/sdf_font.h>
 
 #include "text_renderer.h"
 #include "resource_manager.h"
 
 
+// decodes the UTF-8 sequence at text[i] and advances i past it; invalid bytes decode to U+FFFD
+static char32_t decodeUTF8(const std::string &text, size_t &i)
+{
+    unsigned char lead = text[i++];
+    if (lead < 0x80)
+        return lead;
+    unsigned int length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+    if (length == 0)
+        return 0xFFFD;
+    char32_t code = lead & (0x3F >> length);
+    for (unsigned int n = 0; n < length; ++n, ++i)
+    {
+        if (i == text.size() || (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80)
+            return 0xFFFD;
+        code = (code << 6) | (static_cast<unsigned char>(text[i]) & 0x3F);
+    }
+    return code;
+}
+
 TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+    : capacity(0), baseline(0.0f)
 {
     // load and configure shader
     this->TextShader = ResourceManager::LoadShader("text_2d.vs", "text_2d.fs", nullptr, "text");
     this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
     this->TextShader.SetInteger("text", 0);
-    // configure VAO/VBO for texture quads
+    // configure VAO/VBO for the queued vertices; the buffer grows to fit the most text drawn in a frame
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
     glBindVertexArray(this->VAO);
     glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, PositionTexCoords));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, Color));
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
 
-void TextRenderer::Load(std::string font, unsigned int fontSize)
+TextRenderer::~TextRenderer()
+{
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+    glDeleteTextures(1, &this->Atlas.ID);
+}
+
+void TextRenderer::Load(std::string font, unsigned int fontSize, std::string cacheFile, const std::vector<std::pair<char32_t, char32_t>> &ranges)
 {
     // first clear the previously loaded Characters
     this->Characters.clear();
-    // then initialize and load the FreeType library
-    FT_Library ft;    
-    if (FT_Init_FreeType(&ft)) // all functions return a value different than 0 whenever an error occurred
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-    // load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
-    // set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
-    // disable byte-alignment restriction
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); 
-    // then for the first 128 ASCII characters, pre-load/compile their characters and store them
-    for (GLubyte c = 0; c < 128; c++) // lol see what I did there 
+    glDeleteTextures(1, &this->Atlas.ID);
+    // then load the distance field atlas; it's only generated (with FreeType) if the cache is missing or outdated
+    SdfFont sdf = SdfFont::LoadOrGenerate(cacheFile, font, ranges);
+    if (sdf.GetGlyphs().empty())
+        std::cout << "ERROR::TEXT_RENDERER: Failed to load font" << std::endl;
+    this->Atlas.ID = sdf.CreateTexture();
+    this->Atlas.Width = sdf.GetWidth();
+    this->Atlas.Height = sdf.GetHeight();
+    // the atlas stores glyphs at its base size, scale them to fontSize pixels and flip them to y down
+    float size = static_cast<float>(fontSize) / sdf.GetBaseSize();
+    for (auto &glyph : sdf.GetGlyphs())
     {
-        // load character glyph 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-            continue;
-        }
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-            );
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-       
-        // now store character for later use
         Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            face->glyph->advance.x
+            glyph.second.uvRect,
+            glyph.second.size * size,
+            glyph.second.bearing * size,
+            glyph.second.advance * size
         };
-        Characters.insert(std::pair<char, Character>(c, character));
+        this->Characters[glyph.first] = character;
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
-    // destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    // lines are aligned on the top of a capital letter (the quads are larger than the glyphs by the field's spread)
+    const SdfGlyph *h = sdf.GetGlyph('H');
+    this->baseline = (h ? h->bearing.y - sdf.GetSpread() : sdf.GetAscender()) * size;
+    // and lay out the static texts again with the new Characters
+    for (StaticText &staticText : this->staticTexts)
+    {
+        staticText.Vertices.clear();
+        this->layout(staticText.Text, staticText.X, staticText.Y, staticText.Scale, glm::vec3(1.0f), staticText.Vertices);
+    }
+}
+
+void TextRenderer::RenderText(const std::string &text, float x, float y, float scale, glm::vec3 color)
+{
+    this->layout(text, x, y, scale, color, this->vertices);
+}
+
+unsigned int TextRenderer::AddStaticText(const std::string &text, float x, float y, float scale)
+{
+    StaticText staticText = { text, x, y, scale, std::vector<TextVertex>() };
+    this->layout(text, x, y, scale, glm::vec3(1.0f), staticText.Vertices);
+    this->staticTexts.push_back(staticText);
+    return this->staticTexts.size() - 1;
 }
 
-void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
+void TextRenderer::SetStaticText(unsigned int handle, const std::string &text)
 {
+    StaticText &staticText = this->staticTexts[handle];
+    staticText.Text = text;
+    staticText.Vertices.clear();
+    this->layout(text, staticText.X, staticText.Y, staticText.Scale, glm::vec3(1.0f), staticText.Vertices);
+}
+
+void TextRenderer::RenderStaticText(unsigned int handle, glm::vec3 color)
+{
+    // the laid-out vertices are copied as they are, only their color is set
+    const std::vector<TextVertex> &staticVertices = this->staticTexts[handle].Vertices;
+    size_t first = this->vertices.size();
+    this->vertices.insert(this->vertices.end(), staticVertices.begin(), staticVertices.end());
+    for (size_t i = first; i < this->vertices.size(); ++i)
+        this->vertices[i].Color = color;
+}
+
+void TextRenderer::Flush()
+{
+    unsigned int count = this->vertices.size();
+    if (count == 0)
+        return;
+    // upload all queued text at once, orphaning the buffer so the previous frame's draw isn't waited on
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    if (count > this->capacity)
+        this->capacity = std::max(count, this->capacity * 2);
+    glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(TextVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(TextVertex), this->vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     // activate corresponding render state	
     this->TextShader.Use();
-    this->TextShader.SetVector3f("textColor", color);
     glActiveTexture(GL_TEXTURE0);
+    this->Atlas.Bind();
     glBindVertexArray(this->VAO);
+    // render all glyph quads at once
+    glDrawArrays(GL_TRIANGLES, 0, count);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    this->vertices.clear();
+}
 
+void TextRenderer::layout(const std::string &text, float x, float y, float scale, glm::vec3 color, std::vector<TextVertex> &output)
+{
+    output.reserve(output.size() + text.size() * 6);
+    auto fallback = this->Characters.find('?');
     // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+    for (size_t i = 0; i < text.size();)
     {
-        Character ch = Characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
+        auto found = this->Characters.find(decodeUTF8(text, i));
+        if (found == this->Characters.end())
+            found = fallback;
+        if (found == this->Characters.end())
+            continue;
+        const Character &ch = found->second;
+        // characters without a glyph (spaces) only advance the cursor
+        if (ch.Size.x > 0)
+        {
+            float xpos = x + ch.Bearing.x * scale;
+            float ypos = y + (this->baseline - ch.Bearing.y) * scale;
 
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 0.0f },
+            float w = ch.Size.x * scale;
+            float h = ch.Size.y * scale;
+            glm::vec2 uv0(ch.UVRect.x, ch.UVRect.y);
+            glm::vec2 uv1 = uv0 + glm::vec2(ch.UVRect.z, ch.UVRect.w);
+            // two triangles per glyph, the atlas is stored top row first like the glyphs
+            TextVertex quad[6] = {
+                { { xpos,     ypos + h,   uv0.x, uv1.y }, color },
+                { { xpos + w, ypos,       uv1.x, uv0.y }, color },
+                { { xpos,     ypos,       uv0.x, uv0.y }, color },
 
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f }
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+                { { xpos,     ypos + h,   uv0.x, uv1.y }, color },
+                { { xpos + w, ypos + h,   uv1.x, uv1.y }, color },
+                { { xpos + w, ypos,       uv1.x, uv0.y }, color }
+            };
+            output.insert(output.end(), quad, quad + 6);
+        }
         // now advance cursors for next glyph
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
+        x += ch.Advance * scale;
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
\ No newline at end of file
@@ -9,7 +9,9 @@
 #ifndef TEXT_RENDERER_H
 #define TEXT_RENDERER_H
 
-#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -18,34 +20,70 @@
 #include "shader.h"
 
 
-/// Holds all state information relevant to a character as loaded using FreeType
+/// Holds all state information relevant to a character as loaded from the font's distance field atlas
 struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2   Size;      // size of glyph
-    glm::ivec2   Bearing;   // offset from baseline to left/top of glyph
-    unsigned int Advance;   // horizontal offset to advance to next glyph
+    glm::vec4    UVRect;    // region of the glyph in the glyph atlas: <vec2 offset, vec2 size>
+    glm::vec2    Size;      // size of glyph's quad in pixels
+    glm::vec2    Bearing;   // offset from baseline to left/top of glyph's quad
+    float        Advance;   // horizontal offset in pixels to advance to next glyph
+};
+
+/// A vertex of a laid-out string
+struct TextVertex {
+    glm::vec4    PositionTexCoords; // <vec2 pos, vec2 tex>
+    glm::vec3    Color;
 };
 
 
 // A renderer class for rendering text displayed by a font loaded using the 
-// FreeType library. A single font is loaded, processed into a list of Character
-// items for later rendering.
+// FreeType library. A single font is loaded into a signed distance field atlas
+// (generated once and cached to disk), so text is sharp at any scale. Strings
+// are UTF-8; all text rendered during a frame is queued and drawn by Flush()
+// with a single draw call, and static strings are only laid out once.
 class TextRenderer
 {
 public:
-    // holds a list of pre-compiled Characters
-    std::map<char, Character> Characters; 
+    // holds a list of pre-compiled Characters, by Unicode code point
+    std::unordered_map<char32_t, Character> Characters; 
+    // distance field texture all Characters are packed in
+    Texture2D Atlas;
     // shader used for text rendering
     Shader TextShader;
     // constructor
     TextRenderer(unsigned int width, unsigned int height);
-    // pre-compiles a list of characters from the given font
-    void Load(std::string font, unsigned int fontSize);
-    // renders a string of text using the precompiled list of characters
-    void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // destructor
+    ~TextRenderer();
+    // loads the characters of the given ranges of code points <first, last> from the given font (by default Basic Latin and Latin-1 Supplement);
+    // fontSize is the size text is rendered at with a scale of 1, the atlas is cached in cacheFile
+    void Load(std::string font, unsigned int fontSize, std::string cacheFile, const std::vector<std::pair<char32_t, char32_t>> &ranges = { { 0x20, 0x7E }, { 0xA0, 0xFF } });
+    // queues a string of text using the precompiled list of characters
+    void RenderText(const std::string &text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // lays out a string that's drawn the same way every frame, returns the handle it's rendered with
+    unsigned int AddStaticText(const std::string &text, float x, float y, float scale);
+    // replaces the string of a static text (at the same place), laying it out again
+    void SetStaticText(unsigned int handle, const std::string &text);
+    // queues a static text in the given color
+    void RenderStaticText(unsigned int handle, glm::vec3 color = glm::vec3(1.0f));
+    // renders all text queued since the last Flush with one draw call
+    void Flush();
 private:
     // render state
     unsigned int VAO, VBO;
+    unsigned int capacity; // number of vertices VBO can hold
+    // distance from the top of a line to its baseline, in pixels at a scale of 1
+    float baseline;
+    // vertices of the text queued for the next Flush
+    std::vector<TextVertex> vertices;
+    // a string added with AddStaticText; its text and placement are kept to lay it out again when a font is loaded
+    struct StaticText {
+        std::string             Text;
+        float                   X, Y, Scale;
+        std::vector<TextVertex> Vertices;
+    };
+    // static texts, by handle
+    std::vector<StaticText> staticTexts;
+    // lays out a string and appends its vertices to output
+    void layout(const std::string &text, float x, float y, float scale, glm::vec3 color, std::vector<TextVertex> &output);
 };
 
-#endif 
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -12,16 +12,18 @@
 
 
 Texture2D::Texture2D()
-    : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
+    : ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
 {
-    glGenTextures(1, &this->ID);
+
 }
 
 void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
 {
     this->Width = width;
     this->Height = height;
-    // create Texture
+    // create Texture; the texture object is only created here, so textures can be declared without a GL context
+    if (this->ID == 0)
+        glGenTextures(1, &this->ID);
     glBindTexture(GL_TEXTURE_2D, this->ID);
     glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
     // set Texture wrap and filter modes
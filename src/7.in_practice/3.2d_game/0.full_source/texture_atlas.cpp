@@ -0,0 +1,222 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <fstream>
+
+
+// cache file layout version; bump whenever the packing or the file layout changes
+static const std::uint32_t ATLAS_FILE_MAGIC = 0x314C5441; // "ATL1"
+static const std::uint32_t ATLAS_FILE_VERSION = 1;
+
+TextureAtlas::TextureAtlas()
+    : Width(0), Height(0)
+{
+
+}
+
+void TextureAtlas::Add(std::string name, unsigned int width, unsigned int height, const unsigned char *pixels)
+{
+    Image image;
+    image.Name = name;
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.assign(pixels, pixels + width * height * 4);
+    this->images.push_back(image);
+}
+
+bool TextureAtlas::Pack(unsigned int maxSize)
+{
+    // try increasingly larger atlases until everything fits; at each area the square atlas
+    // is tried first, then the wide and the tall one (wide images don't always pair up in a square)
+    std::vector<glm::uvec2> positions;
+    glm::uvec2 size(0);
+    for (unsigned int side = 64; side <= maxSize && size.x == 0; side *= 2)
+    {
+        glm::uvec2 candidates[] = { glm::uvec2(side, side), glm::uvec2(side * 2, side), glm::uvec2(side, side * 2) };
+        for (glm::uvec2 candidate : candidates)
+        {
+            if (candidate.x <= maxSize && candidate.y <= maxSize && this->place(candidate.x, candidate.y, positions))
+            {
+                size = candidate;
+                break;
+            }
+        }
+    }
+    if (size.x == 0)
+        return false;
+    this->Width = size.x;
+    this->Height = size.y;
+    this->Pixels.assign(this->Width * this->Height * 4, 0);
+    this->Regions.clear();
+    for (unsigned int i = 0; i < this->images.size(); ++i)
+    {
+        const Image &image = this->images[i];
+        this->blit(image, positions[i]);
+        glm::vec2 offset = glm::vec2(positions[i] + PADDING) / glm::vec2(size);
+        glm::vec2 extent = glm::vec2(image.Width, image.Height) / glm::vec2(size);
+        this->Regions[image.Name] = glm::vec4(offset, extent);
+    }
+    this->images.clear();
+    return true;
+}
+
+bool TextureAtlas::Save(const char *file, std::uint64_t key) const
+{
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream)
+        return false;
+    std::uint32_t header[5] = { ATLAS_FILE_MAGIC, ATLAS_FILE_VERSION, this->Width, this->Height, static_cast<std::uint32_t>(this->Regions.size()) };
+    stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    for (auto &region : this->Regions)
+    {
+        std::uint32_t length = region.first.size();
+        stream.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        stream.write(region.first.data(), length);
+        stream.write(reinterpret_cast<const char*>(&region.second), sizeof(glm::vec4));
+    }
+    stream.write(reinterpret_cast<const char*>(this->Pixels.data()), this->Pixels.size());
+    return static_cast<bool>(stream);
+}
+
+bool TextureAtlas::Load(const char *file, std::uint64_t key)
+{
+    std::ifstream stream(file, std::ios::binary);
+    std::uint32_t header[5];
+    std::uint64_t fileKey;
+    if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)) || !stream.read(reinterpret_cast<char*>(&fileKey), sizeof(fileKey)))
+        return false;
+    if (header[0] != ATLAS_FILE_MAGIC || header[1] != ATLAS_FILE_VERSION || fileKey != key)
+        return false;
+    std::map<std::string, glm::vec4> regions;
+    for (std::uint32_t i = 0; i < header[4]; ++i)
+    {
+        std::uint32_t length;
+        if (!stream.read(reinterpret_cast<char*>(&length), sizeof(length)))
+            return false;
+        std::string name(length, '\0');
+        glm::vec4 rect;
+        if (!stream.read(&name[0], length) || !stream.read(reinterpret_cast<char*>(&rect), sizeof(rect)))
+            return false;
+        regions[name] = rect;
+    }
+    std::vector<unsigned char> pixels(static_cast<size_t>(header[2]) * header[3] * 4);
+    if (!stream.read(reinterpret_cast<char*>(pixels.data()), pixels.size()))
+        return false;
+    this->Width = header[2];
+    this->Height = header[3];
+    this->Regions.swap(regions);
+    this->Pixels.swap(pixels);
+    this->images.clear();
+    return true;
+}
+
+Texture2D TextureAtlas::Generate() const
+{
+    Texture2D texture;
+    texture.Internal_Format = GL_RGBA;
+    texture.Image_Format = GL_RGBA;
+    // the padding already covers filtering at the image borders, clamping avoids wrapping at the atlas border
+    texture.Wrap_S = GL_CLAMP_TO_EDGE;
+    texture.Wrap_T = GL_CLAMP_TO_EDGE;
+    texture.Generate(this->Width, this->Height, const_cast<unsigned char*>(this->Pixels.data()));
+    return texture;
+}
+
+bool TextureAtlas::place(unsigned int width, unsigned int height, std::vector<glm::uvec2> &positions) const
+{
+    // pack the tallest images first, they're the hardest to fit
+    std::vector<unsigned int> order(this->images.size());
+    for (unsigned int i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+        if (this->images[a].Height != this->images[b].Height)
+            return this->images[a].Height > this->images[b].Height;
+        return this->images[a].Width > this->images[b].Width;
+    });
+
+    positions.assign(this->images.size(), glm::uvec2(0));
+    std::vector<SkylineNode> skyline(1, SkylineNode{ 0, 0, width });
+    for (unsigned int index : order)
+    {
+        unsigned int imageWidth = this->images[index].Width + 2 * PADDING;
+        unsigned int imageHeight = this->images[index].Height + 2 * PADDING;
+        // bottom-left rule: the lowest position the image can rest on, leftmost on ties
+        unsigned int bestNode = skyline.size(), bestY = height;
+        for (unsigned int i = 0; i < skyline.size(); ++i)
+        {
+            if (skyline[i].X + imageWidth > width)
+                break;
+            // the image rests on the highest node below its span
+            unsigned int y = 0, covered = 0;
+            for (unsigned int j = i; covered < imageWidth; ++j)
+            {
+                y = std::max(y, skyline[j].Y);
+                covered += skyline[j].Width;
+            }
+            if (y + imageHeight <= height && y < bestY)
+            {
+                bestNode = i;
+                bestY = y;
+            }
+        }
+        if (bestNode == skyline.size())
+            return false;
+        positions[index] = glm::uvec2(skyline[bestNode].X, bestY);
+
+        // raise the skyline under the image, shrinking or removing the nodes it now covers
+        SkylineNode node = { skyline[bestNode].X, bestY + imageHeight, imageWidth };
+        skyline.insert(skyline.begin() + bestNode, node);
+        for (unsigned int i = bestNode + 1; i < skyline.size();)
+        {
+            unsigned int end = node.X + node.Width;
+            if (skyline[i].X >= end)
+                break;
+            unsigned int overlap = end - skyline[i].X;
+            if (skyline[i].Width <= overlap)
+            {
+                skyline.erase(skyline.begin() + i);
+                continue;
+            }
+            skyline[i].X += overlap;
+            skyline[i].Width -= overlap;
+            break;
+        }
+        // merge neighbours at the same height
+        for (unsigned int i = 0; i + 1 < skyline.size();)
+        {
+            if (skyline[i].Y == skyline[i + 1].Y)
+            {
+                skyline[i].Width += skyline[i + 1].Width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else
+                ++i;
+        }
+    }
+    return true;
+}
+
+void TextureAtlas::blit(const Image &image, glm::uvec2 position)
+{
+    // every texel of the padded rectangle copies the closest texel of the image
+    for (unsigned int y = 0; y < image.Height + 2 * PADDING; ++y)
+    {
+        unsigned int sourceY = std::min(std::max(y, PADDING) - PADDING, image.Height - 1);
+        unsigned char *row = &this->Pixels[((position.y + y) * this->Width + position.x) * 4];
+        for (unsigned int x = 0; x < image.Width + 2 * PADDING; ++x)
+        {
+            unsigned int sourceX = std::min(std::max(x, PADDING) - PADDING, image.Width - 1);
+            const unsigned char *source = &image.Pixels[(sourceY * image.Width + sourceX) * 4];
+            std::copy(source, source + 4, row + x * 4);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+
+
+// TextureAtlas packs many small RGBA images into a single image so
+// they can all be rendered with one texture binding. Images are
+// placed with a skyline bottom-left packer; each is padded with
+// copies of its border pixels so linear filtering never bleeds in
+// its neighbours. The packed image can be cached to disk.
+class TextureAtlas
+{
+public:
+    // packed image state
+    unsigned int               Width, Height;
+    std::vector<unsigned char> Pixels; // RGBA, Width * Height texels
+    // texture coordinates of each packed image: <vec2 offset, vec2 size>
+    std::map<std::string, glm::vec4> Regions;
+    // constructor
+    TextureAtlas();
+    // adds an RGBA image to pack (the pixels are copied)
+    void      Add(std::string name, unsigned int width, unsigned int height, const unsigned char *pixels);
+    // packs all added images into the smallest power of two atlas with sides not larger than maxSize; returns false if they don't fit
+    bool      Pack(unsigned int maxSize = 4096);
+    // writes/reads the packed atlas to/from a cache file; key identifies the source images the atlas was packed from
+    bool      Save(const char *file, std::uint64_t key) const;
+    bool      Load(const char *file, std::uint64_t key);
+    // generates the texture holding the packed atlas
+    Texture2D Generate() const;
+private:
+    // images waiting to be packed
+    struct Image {
+        std::string                Name;
+        unsigned int               Width, Height;
+        std::vector<unsigned char> Pixels;
+    };
+    std::vector<Image> images;
+    // a horizontal segment of the skyline: the top of the images packed below [X, X + Width)
+    struct SkylineNode {
+        unsigned int X, Y, Width;
+    };
+    // texels of border copies around each image
+    static constexpr unsigned int PADDING = 2;
+    // places all images in a width x height atlas, returns false if they don't fit
+    bool place(unsigned int width, unsigned int height, std::vector<glm::uvec2> &positions) const;
+    // copies an image into Pixels at the given position and extrudes its border into the padding
+    void blit(const Image &image, glm::uvec2 position);
+};
+
+#endif
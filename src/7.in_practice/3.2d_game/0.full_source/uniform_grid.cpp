@@ -0,0 +1,67 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "uniform_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+UniformGrid::UniformGrid()
+    : origin(0.0f), cellSize(1.0f), columns(1), rows(1), cells(1)
+{
+
+}
+
+void UniformGrid::Reset(glm::vec2 origin, glm::vec2 size, glm::vec2 cellSize)
+{
+    this->origin = origin;
+    this->cellSize = cellSize;
+    this->columns = std::max(1, static_cast<int>(std::ceil(size.x / cellSize.x)));
+    this->rows = std::max(1, static_cast<int>(std::ceil(size.y / cellSize.y)));
+    this->cells.assign(this->columns * this->rows, std::vector<unsigned int>());
+}
+
+void UniformGrid::Clear()
+{
+    for (std::vector<unsigned int> &cell : this->cells)
+        cell.clear();
+}
+
+void UniformGrid::Insert(unsigned int index, glm::vec2 position, glm::vec2 size)
+{
+    glm::ivec2 first, last;
+    this->cellRange(position, size, first, last);
+    for (int y = first.y; y <= last.y; ++y)
+        for (int x = first.x; x <= last.x; ++x)
+            this->cells[y * this->columns + x].push_back(index);
+}
+
+void UniformGrid::Query(glm::vec2 position, glm::vec2 size, std::vector<unsigned int> &result) const
+{
+    result.clear();
+    glm::ivec2 first, last;
+    this->cellRange(position, size, first, last);
+    for (int y = first.y; y <= last.y; ++y)
+        for (int x = first.x; x <= last.x; ++x)
+        {
+            const std::vector<unsigned int> &cell = this->cells[y * this->columns + x];
+            result.insert(result.end(), cell.begin(), cell.end());
+        }
+    // objects spanning several cells are found once per cell; sorting also keeps the caller's processing order stable
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+void UniformGrid::cellRange(glm::vec2 position, glm::vec2 size, glm::ivec2 &first, glm::ivec2 &last) const
+{
+    // boxes are closed, so a box ending exactly on a cell border also lands in the next cell (touching boxes always share a cell)
+    glm::ivec2 maxCell(this->columns - 1, this->rows - 1);
+    first = glm::clamp(glm::ivec2(glm::floor((position - this->origin) / this->cellSize)), glm::ivec2(0), maxCell);
+    last = glm::clamp(glm::ivec2(glm::floor((position + size - this->origin) / this->cellSize)), glm::ivec2(0), maxCell);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef UNIFORM_GRID_H
+#define UNIFORM_GRID_H
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+// UniformGrid is a collision broadphase: it buckets axis aligned boxes
+// into equally sized cells so a query only visits the objects stored in
+// the cells it overlaps instead of every object. Objects are referred to
+// by index (e.g. into a vector of GameObjects). Filled once, it serves as
+// a static grid; cleared and refilled every frame, as a dynamic one.
+class UniformGrid
+{
+public:
+    // constructor
+    UniformGrid();
+    // covers the area [origin, origin + size] with cells of cellSize and removes all objects; anything outside is kept in the border cells
+    void Reset(glm::vec2 origin, glm::vec2 size, glm::vec2 cellSize);
+    // removes all objects, keeping the grid layout (and its memory)
+    void Clear();
+    // stores object index in every cell its box [position, position + size] overlaps
+    void Insert(unsigned int index, glm::vec2 position, glm::vec2 size);
+    // retrieves (in increasing order, without duplicates) the indices of all objects sharing a cell with the box [position, position + size]
+    void Query(glm::vec2 position, glm::vec2 size, std::vector<unsigned int> &result) const;
+private:
+    // grid state
+    glm::vec2    origin, cellSize;
+    unsigned int columns, rows;
+    std::vector<std::vector<unsigned int>> cells; // object indices per cell, row by row
+    // computes the (clamped) range of cells a box overlaps
+    void cellRange(glm::vec2 position, glm::vec2 size, glm::ivec2 &first, glm::ivec2 &last) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include <glm/glm.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/animation.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+// compresses the keyframes of the dancing vampire clip and reports the compression ratio and the model space error
+// per joint.
+// runs headless: the animation is loaded without its model, so no window or OpenGL context is needed.
+// usage: animation_compression [position tolerance] [rotation tolerance in radians]
+int main(int argc, char* argv[])
+{
+	const float positionTolerance = argc > 1 ? static_cast<float>(std::atof(argv[1])) : 0.001f;
+	const float rotationTolerance = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 0.0005f;
+
+	// load the animation
+	// ------------------
+	std::map<std::string, BoneInfo> boneInfoMap;
+	int boneCount = 0;
+	Animation danceAnimation(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"), boneInfoMap, boneCount);
+	const std::vector<SkeletonNode>& skeleton = danceAnimation.GetSkeleton();
+
+	// compress it
+	// -----------
+	ClipCompressionReport report = danceAnimation.Compress(positionTolerance, rotationTolerance);
+
+	std::cout << "tolerances: position " << positionTolerance << ", rotation " << rotationTolerance << " rad" << std::endl;
+	std::cout << "keys: " << report.rawKeyCount << " -> " << report.compressedKeyCount << " (" << report.passes << " reduction passes)" << std::endl;
+	std::cout << "size: " << report.rawSize << " -> " << report.compressedSize << " bytes (ratio " << report.GetRatio() << ":1)" << std::endl;
+	std::cout << std::endl;
+
+	// max error per animated joint
+	// ----------------------------
+	float maxPositionError = 0.0f, maxRotationError = 0.0f;
+	std::cout << std::left << std::setw(40) << "joint" << std::setw(16) << "position error" << "rotation error (deg)" << std::endl;
+	for (size_t i = 0; i < skeleton.size(); ++i)
+	{
+		if (skeleton[i].channelIndex < 0)
+			continue;
+
+		std::cout << std::left << std::setw(40) << danceAnimation.GetNodeName(static_cast<int>(i))
+			<< std::setw(16) << report.maxPositionError[i] << glm::degrees(report.maxRotationError[i]) << std::endl;
+		maxPositionError = std::max(maxPositionError, report.maxPositionError[i]);
+		maxRotationError = std::max(maxRotationError, report.maxRotationError[i]);
+	}
+	std::cout << std::endl << "max error: position " << maxPositionError << ", rotation " << glm::degrees(maxRotationError) << " deg" << std::endl;
+
+	// still out of tolerance after the last pass: the quantization (16 bit times and positions, 15 bit rotation
+	// components) is coarser than the tolerance for this skeleton
+	if (maxPositionError > positionTolerance)
+		std::cout << "position tolerance not reached, the quantization step is larger than the tolerance" << std::endl;
+	return 0;
+}
@@ -0,0 +1,148 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/animator.h>
+#include <learnopengl/cpu_skinning.h>
+#include <learnopengl/model_animation.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// skins the dancing vampire on the CPU with every kernel, checks each one against the reference per vertex
+// implementation and reports their throughput in vertices/second. then checks that dual quaternion skinning
+// matches linear blend skinning wherever the skin moves rigidly.
+// no window is shown, a hidden one only provides the OpenGL context the model needs to load.
+int main()
+{
+	// glfw: initialize and create a hidden window for the context
+	// ------------------------------------------------------------
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(1, 1, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// load the model and pose it
+	// --------------------------
+	Model ourModel(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"));
+	Animation danceAnimation(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"), &ourModel);
+	Animator animator(&danceAnimation);
+	animator.UpdateAnimation(0.5f);
+	const glm::mat4* palette = animator.GetFinalBoneMatrices().data();
+
+	CpuSkinner skinner(ourModel);
+	ThreadPool threadPool;
+	std::cout << skinner.GetVertexCount() << " vertices, AVX2 " << (CpuSkinner::IsAvx2Supported() ? "supported" : "not supported")
+		<< ", " << threadPool.GetWorkerCount() << " workers" << std::endl;
+
+	// reference: one vertex at a time, straight from the model's vertices
+	// -------------------------------------------------------------------
+	std::vector<glm::vec3> referencePositions, referenceNormals;
+	for (const Mesh& mesh : ourModel.meshes)
+	{
+		for (const Vertex& vertex : mesh.vertices)
+		{
+			referencePositions.push_back(glm::vec3(CpuSkinner::SkinVertex(vertex, palette)));
+			referenceNormals.push_back(CpuSkinner::SkinNormal(vertex, palette));
+		}
+	}
+
+	// every kernel, single threaded then on the thread pool
+	// -----------------------------------------------------
+	struct Run { const char* name; SkinningKernel kernel; ThreadPool* threadPool; };
+	const Run runs[] = {
+		{ "scalar", SkinningKernel::Scalar, nullptr },
+		{ "scalar, thread pool", SkinningKernel::Scalar, &threadPool },
+		{ "avx2", SkinningKernel::Avx2, nullptr },
+		{ "avx2, thread pool", SkinningKernel::Avx2, &threadPool },
+	};
+	for (const Run& run : runs)
+	{
+		skinner.Skin(palette, run.threadPool, run.kernel);
+		float maxPositionError = 0.0f, maxNormalError = 0.0f;
+		for (std::size_t v = 0; v < skinner.GetVertexCount(); ++v)
+		{
+			maxPositionError = std::max(maxPositionError, glm::length(skinner.GetPosition(v) - referencePositions[v]));
+			maxNormalError = std::max(maxNormalError, glm::length(skinner.GetNormal(v) - referenceNormals[v]));
+		}
+
+		const int iterations = 200;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; ++i)
+			skinner.Skin(palette, run.threadPool, run.kernel);
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		std::cout << run.name << ": " << skinner.GetVertexCount() * iterations / elapsed.count() / 1e6 << " M vertices/s, max error: position "
+			<< maxPositionError << ", normal " << maxNormalError << std::endl;
+	}
+
+	// dual quaternion skinning: same result as linear blend skinning for rigid poses
+	// --------------------------------------------------------------------------------
+	animator.SetDualQuaternionOutput(true);
+	animator.UpdateAnimation(0.0f);
+	const glm::dualquat* dualQuaternions = animator.GetDualQuaternions().data();
+
+	// a single rigid transform shared by every bone
+	const glm::mat4 rigidTransform = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.5f, 1.0f, -2.0f)), 1.3f, glm::normalize(glm::vec3(1.0f, 2.0f, -1.0f)));
+	const std::vector<glm::mat4> rigidPalette(animator.GetFinalBoneMatrices().size(), rigidTransform);
+	const std::vector<glm::dualquat> rigidDualQuaternions(rigidPalette.size(), Animator::ToDualQuaternion(rigidTransform));
+
+	float maxSingleInfluenceError = 0.0f, maxRigidError = 0.0f, maxBlendDifference = 0.0f;
+	for (const Mesh& mesh : ourModel.meshes)
+	{
+		for (const Vertex& vertex : mesh.vertices)
+		{
+			glm::vec3 normal;
+			const glm::vec3 position = CpuSkinner::SkinVertex(vertex, dualQuaternions, &normal);
+			const glm::vec3 linearPosition = glm::vec3(CpuSkinner::SkinVertex(vertex, palette));
+			int influences = 0;
+			for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+				influences += vertex.m_BoneIDs[i] != -1 && vertex.m_Weights[i] > 0.0f;
+
+			// vertices bound to a single bone move rigidly in the animated pose too
+			if (influences == 1)
+			{
+				maxSingleInfluenceError = std::max(maxSingleInfluenceError, glm::length(position - linearPosition));
+				maxSingleInfluenceError = std::max(maxSingleInfluenceError, glm::length(normal - CpuSkinner::SkinNormal(vertex, palette)));
+			}
+			else
+			{
+				maxBlendDifference = std::max(maxBlendDifference, glm::length(position - linearPosition));
+			}
+
+			const glm::vec3 rigidPosition = CpuSkinner::SkinVertex(vertex, rigidDualQuaternions.data(), &normal);
+			maxRigidError = std::max(maxRigidError, glm::length(rigidPosition - glm::vec3(CpuSkinner::SkinVertex(vertex, rigidPalette.data()))));
+			maxRigidError = std::max(maxRigidError, glm::length(normal - CpuSkinner::SkinNormal(vertex, rigidPalette.data())));
+		}
+	}
+	std::cout << "dual quaternion vs linear blend skinning: single influence vertices " << maxSingleInfluenceError
+		<< ", rigid pose " << maxRigidError << " (max errors), blended vertices differ by up to " << maxBlendDifference << std::endl;
+
+	glfwTerminate();
+	return 0;
+}
@@ -12,28 +12,71 @@ uniform mat4 projection;
 uniform mat4 view;
 uniform mat4 model;
 
-const int MAX_BONES = 100;
 const int MAX_BONE_INFLUENCE = 4;
-uniform mat4 finalBonesMatrices[MAX_BONES];
+// bone matrices, 4 texels (columns) per matrix; this draw's palette starts at matrix paletteOffset
+uniform samplerBuffer bonePalette;
+uniform int paletteOffset;
+// the palette holds dual quaternions instead, 2 texels per bone: real part then dual part
+uniform bool dualQuaternionSkinning;
 
 out vec2 TexCoords;
 
-void main()
+mat4 getBoneMatrix(int bone)
 {
-    vec4 totalPosition = vec4(0.0f);
+    int texel = (paletteOffset + bone) * 4;
+    return mat4(texelFetch(bonePalette, texel), texelFetch(bonePalette, texel + 1),
+                texelFetch(bonePalette, texel + 2), texelFetch(bonePalette, texel + 3));
+}
+
+// blend the dual quaternions of the influences and apply the result as a single rigid transform
+vec4 skinDualQuaternion()
+{
+    vec4 real = vec4(0.0f);
+    vec4 dual = vec4(0.0f);
+    vec4 pivot = vec4(0.0f);
     for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++)
     {
         if(boneIds[i] == -1) 
             continue;
-        if(boneIds[i] >=MAX_BONES) 
+        int texel = (paletteOffset + boneIds[i]) * 2;
+        vec4 boneReal = texelFetch(bonePalette, texel);
+        vec4 boneDual = texelFetch(bonePalette, texel + 1);
+        // q and -q are the same rotation, keep every influence in the hemisphere of the first one
+        if(pivot == vec4(0.0f))
+            pivot = boneReal;
+        float weight = dot(pivot, boneReal) < 0.0f ? -weights[i] : weights[i];
+        real += boneReal * weight;
+        dual += boneDual * weight;
+    }
+
+    float len = length(real);
+    if(len == 0.0f)
+        return vec4(0.0f);
+    real /= len;
+    dual /= len;
+
+    vec3 rotated = pos + 2.0f * cross(real.xyz, cross(real.xyz, pos) + real.w * pos);
+    vec3 translation = 2.0f * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+    return vec4(rotated + translation, 1.0f);
+}
+
+void main()
+{
+    vec4 totalPosition = vec4(0.0f);
+    if(dualQuaternionSkinning)
+        totalPosition = skinDualQuaternion();
+    else
+    {
+        for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++)
         {
-            totalPosition = vec4(pos,1.0f);
-            break;
+            if(boneIds[i] == -1) 
+                continue;
+            mat4 boneMatrix = getBoneMatrix(boneIds[i]);
+            vec4 localPosition = boneMatrix * vec4(pos,1.0f);
+            totalPosition += localPosition * weights[i];
+            vec3 localNormal = mat3(boneMatrix) * norm;
         }
-        vec4 localPosition = finalBonesMatrices[boneIds[i]] * vec4(pos,1.0f);
-        totalPosition += localPosition * weights[i];
-        vec3 localNormal = mat3(finalBonesMatrices[boneIds[i]]) * norm;
-   }
+    }
 	
     mat4 viewModel = view * model;
     gl_Position =  projection * viewModel * totalPosition;
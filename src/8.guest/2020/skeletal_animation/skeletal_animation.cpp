@@ -9,10 +9,12 @@
 #include <learnopengl/shader_m.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/animator.h>
+#include <learnopengl/bone_palette_buffer.h>
 #include <learnopengl/model_animation.h>
 
 
 
+#include <chrono>
 #include <iostream>
 
 
@@ -31,6 +33,12 @@ float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 
+// texture unit of the bone palette, above the units used by the model's textures
+const unsigned int BONE_PALETTE_UNIT = 15;
+
+// skinning: press 1 for linear blend skinning (mat4 palette), 2 for dual quaternion skinning (half the palette size)
+bool dualQuaternionSkinning = false;
+
 // timing
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
@@ -90,6 +98,19 @@ int main()
 	Model ourModel(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"));
 	Animation danceAnimation(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"),&ourModel);
 	Animator animator(&danceAnimation);
+	BonePaletteBuffer bonePalette;
+
+	// measure how many skeleton evaluations per second the animator sustains
+	{
+		Animator benchmarkAnimator(&danceAnimation);
+		const int evaluations = 10000;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < evaluations; ++i)
+			benchmarkAnimator.UpdateAnimation(1.0f / 60.0f);
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		std::cout << "Skeleton: " << danceAnimation.GetSkeleton().size() << " nodes, "
+			<< evaluations / elapsed.count() << " evaluations/s" << std::endl;
+	}
 
 
 	// draw in wireframe
@@ -108,6 +129,8 @@ int main()
 		// input
 		// -----
 		processInput(window);
+		// the bones are only converted to dual quaternions while they're used for skinning
+		animator.SetDualQuaternionOutput(dualQuaternionSkinning);
 		animator.UpdateAnimation(deltaTime);
 		
 		// render
@@ -124,9 +147,21 @@ int main()
 		ourShader.setMat4("projection", projection);
 		ourShader.setMat4("view", view);
 
-        auto transforms = animator.GetFinalBoneMatrices();
-		for (int i = 0; i < transforms.size(); ++i)
-			ourShader.setMat4("finalBonesMatrices[" + std::to_string(i) + "]", transforms[i]);
+		// upload the whole bone palette with a single buffer update
+		if (dualQuaternionSkinning)
+		{
+			const std::vector<glm::dualquat>& dualQuaternions = animator.GetDualQuaternions();
+			bonePalette.Upload(dualQuaternions.data(), dualQuaternions.size());
+		}
+		else
+		{
+			const std::vector<glm::mat4>& transforms = animator.GetFinalBoneMatrices();
+			bonePalette.Upload(transforms.data(), transforms.size());
+		}
+		bonePalette.Bind(BONE_PALETTE_UNIT);
+		ourShader.setBool("dualQuaternionSkinning", dualQuaternionSkinning);
+		ourShader.setInt("bonePalette", BONE_PALETTE_UNIT);
+		ourShader.setInt("paletteOffset", 0);
 
 
 		// render the loaded model
@@ -164,6 +199,11 @@ void processInput(GLFWwindow* window)
 		camera.ProcessKeyboard(LEFT, deltaTime);
 	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
 		camera.ProcessKeyboard(RIGHT, deltaTime);
+
+	if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+		dualQuaternionSkinning = false;
+	if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+		dualQuaternionSkinning = true;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
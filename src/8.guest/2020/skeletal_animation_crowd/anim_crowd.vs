@@ -0,0 +1,45 @@
+#version 330 core
+
+layout(location = 0) in vec3 pos;
+layout(location = 1) in vec3 norm;
+layout(location = 2) in vec2 tex;
+layout(location = 3) in vec3 tangent;
+layout(location = 4) in vec3 bitangent;
+layout(location = 5) in ivec4 boneIds; 
+layout(location = 6) in vec4 weights;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+const int MAX_BONE_INFLUENCE = 4;
+// bone matrices, 4 texels (columns) per matrix; this draw's palette starts at matrix paletteOffset
+uniform samplerBuffer bonePalette;
+uniform int paletteOffset;
+
+out vec2 TexCoords;
+
+mat4 getBoneMatrix(int bone)
+{
+    int texel = (paletteOffset + bone) * 4;
+    return mat4(texelFetch(bonePalette, texel), texelFetch(bonePalette, texel + 1),
+                texelFetch(bonePalette, texel + 2), texelFetch(bonePalette, texel + 3));
+}
+
+void main()
+{
+    vec4 totalPosition = vec4(0.0f);
+    for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++)
+    {
+        if(boneIds[i] == -1) 
+            continue;
+        mat4 boneMatrix = getBoneMatrix(boneIds[i]);
+        vec4 localPosition = boneMatrix * vec4(pos,1.0f);
+        totalPosition += localPosition * weights[i];
+        vec3 localNormal = mat3(boneMatrix) * norm;
+   }
+	
+    mat4 viewModel = view * model;
+    gl_Position =  projection * viewModel * totalPosition;
+	TexCoords = tex;
+}
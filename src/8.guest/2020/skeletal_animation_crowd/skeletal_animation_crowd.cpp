@@ -0,0 +1,282 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader_m.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/bone_palette_buffer.h>
+#include <learnopengl/crowd_animator.h>
+#include <learnopengl/model_animation.h>
+#include <learnopengl/entity.h>
+
+
+
+#include <chrono>
+#include <iostream>
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// crowd
+const int CROWD_ROWS = 10;
+const int CROWD_COLUMNS = 10;
+glm::vec3 crowdPosition(int instance);
+
+// animation level of detail: full rate up close, then every 2nd, 4th and 8th frame with fewer bones
+const std::vector<AnimationLodLevel> CROWD_LOD_LEVELS = { { 0.0f, 1, 0 }, { 10.0f, 2, 0 }, { 13.0f, 4, 1 }, { 16.0f, 8, 2 } };
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.5f, 8.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+// texture unit of the bone palettes, above the units used by the model's textures
+const unsigned int BONE_PALETTE_UNIT = 15;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+int main()
+{
+	// glfw: initialize and configure
+	// ------------------------------
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// glfw window creation
+	// --------------------
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// tell GLFW to capture our mouse
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// glad: load all OpenGL function pointers
+	// ---------------------------------------
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
+	stbi_set_flip_vertically_on_load(true);
+
+	// configure global opengl state
+	// -----------------------------
+	glEnable(GL_DEPTH_TEST);
+
+	// build and compile shaders
+	// -------------------------
+	Shader ourShader("anim_crowd.vs", "anim_crowd.fs");
+
+	
+	// load models
+	// -----------
+	Model ourModel(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"));
+	Animation danceAnimation(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"),&ourModel);
+	ThreadPool threadPool;
+
+	// scaling benchmark: time per update of crowds from 1 to 1000 characters sharing the dance animation
+	{
+		std::cout << "Crowd animation on " << threadPool.GetWorkerCount() << " workers" << std::endl;
+		for (int instanceCount : { 1, 10, 100, 250, 500, 1000 })
+		{
+			// once with every instance at full detail, once spread from 0 to 20 units away from the camera
+			for (bool useLod : { false, true })
+			{
+				CrowdAnimator benchmarkCrowd(&danceAnimation, threadPool);
+				benchmarkCrowd.SetLodLevels(CROWD_LOD_LEVELS);
+				for (int i = 0; i < instanceCount; ++i)
+				{
+					benchmarkCrowd.AddInstance(i * 0.37f);
+					if (useLod)
+						benchmarkCrowd.SetInstanceVisibility(i, 20.0f * i / instanceCount, true);
+				}
+
+				const int frames = 100;
+				auto start = std::chrono::high_resolution_clock::now();
+				for (int frame = 0; frame < frames; ++frame)
+					benchmarkCrowd.UpdateAnimation(1.0f / 60.0f);
+				std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+				std::cout << instanceCount << " instances" << (useLod ? " with lod: " : ": ") << elapsed.count() / frames << " ms/update, "
+					<< benchmarkCrowd.GetLodStats().GetSavedFraction() * 100.0f << "% of the channel samples saved" << std::endl;
+			}
+		}
+	}
+
+	// every character starts the dance at its own time and plays it at its own speed
+	CrowdAnimator crowd(&danceAnimation, threadPool);
+	for (int i = 0; i < CROWD_ROWS * CROWD_COLUMNS; ++i)
+		crowd.AddInstance(i * 0.37f, 0.8f + 0.4f * (i % 7) / 6.0f);
+	crowd.SetLodLevels(CROWD_LOD_LEVELS);
+	BonePaletteBuffer bonePalettes;
+	float lastStatsTime = 0.0f;
+
+
+	// draw in wireframe
+	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+	// render loop
+	// -----------
+	while (!glfwWindowShouldClose(window))
+	{
+		// per-frame time logic
+		// --------------------
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		processInput(window);
+
+		// select the level of detail of every character, the ones outside of the view frustum are frozen
+		const Frustum camFrustum = createFrustumFromCamera(camera, (float)SCR_WIDTH / (float)SCR_HEIGHT, glm::radians(camera.Zoom), 0.1f, 100.0f);
+		for (int i = 0; i < crowd.GetInstanceCount(); ++i)
+		{
+			const Sphere bounds(crowdPosition(i) + glm::vec3(0.0f, 0.5f, 0.0f), 0.75f);
+			crowd.SetInstanceVisibility(i, glm::length(crowdPosition(i) - camera.Position), bounds.BoundingVolume::isOnFrustum(camFrustum));
+		}
+		crowd.UpdateAnimation(deltaTime);
+
+		if (currentFrame - lastStatsTime >= 1.0f)
+		{
+			const AnimationLodStats& stats = crowd.GetLodStats();
+			std::cout << stats.evaluatedInstances << " evaluated, " << stats.interpolatedInstances << " interpolated, " << stats.frozenInstances
+				<< " frozen, " << stats.GetSavedFraction() * 100.0f << "% of the channel samples saved" << std::endl;
+			lastStatsTime = currentFrame;
+		}
+		
+		// render
+		// ------
+		glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// don't forget to enable shader before setting uniforms
+		ourShader.use();
+
+		// view/projection transformations
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+		glm::mat4 view = camera.GetViewMatrix();
+		ourShader.setMat4("projection", projection);
+		ourShader.setMat4("view", view);
+
+		// upload the palettes of the whole crowd at once, every draw then only selects its palette offset
+		const std::vector<glm::mat4>& palettes = crowd.GetPalettes();
+		bonePalettes.Upload(palettes.data(), palettes.size());
+		bonePalettes.Bind(BONE_PALETTE_UNIT);
+		ourShader.setInt("bonePalette", BONE_PALETTE_UNIT);
+
+		// render the crowd, one character at a time
+		for (int i = 0; i < crowd.GetInstanceCount(); ++i)
+		{
+			ourShader.setInt("paletteOffset", i * crowd.GetPaletteSize());
+
+			glm::mat4 model = glm::mat4(1.0f);
+			model = glm::translate(model, crowdPosition(i));
+			model = glm::scale(model, glm::vec3(.5f, .5f, .5f));
+			ourShader.setMat4("model", model);
+			ourModel.Draw(ourShader);
+		}
+
+
+		// glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+		// -------------------------------------------------------------------------------
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+	return 0;
+}
+
+// feet position of a character of the crowd
+// ------------------------------------------
+glm::vec3 crowdPosition(int instance)
+{
+	return glm::vec3((instance % CROWD_COLUMNS - CROWD_COLUMNS / 2) * 1.0f, -0.4f, -(instance / CROWD_COLUMNS) * 1.0f);
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
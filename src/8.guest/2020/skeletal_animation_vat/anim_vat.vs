@@ -0,0 +1,68 @@
+#version 330 core
+
+layout(location = 0) in vec3 pos;
+layout(location = 1) in vec3 norm;
+layout(location = 2) in vec2 tex;
+layout(location = 3) in vec3 tangent;
+layout(location = 4) in vec3 bitangent;
+layout(location = 5) in ivec4 boneIds; 
+layout(location = 6) in vec4 weights;
+layout(location = 7) in vec4 instance; // xyz: position of the character, w: time offset in seconds
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+uniform float time;
+
+const int MAX_BONE_INFLUENCE = 4;
+// baked animation, frame f starts at texel f * texelsPerFrame; the texels are stored in rows of the texture's width
+uniform sampler2D bakedAnimation;
+uniform int texelsPerFrame;
+uniform int frameCount;
+uniform float frameRate;
+// the frames hold skinned vertex positions instead of bone matrices, the first vertex of this mesh is vertexOffset
+uniform bool bakedVertices;
+uniform int vertexOffset;
+
+out vec2 TexCoords;
+
+vec4 fetchTexel(int texel)
+{
+    int width = textureSize(bakedAnimation, 0).x;
+    return texelFetch(bakedAnimation, ivec2(texel % width, texel / width), 0);
+}
+
+mat4 getBoneMatrix(int frame, int bone)
+{
+    int texel = frame * texelsPerFrame + bone * 4;
+    return mat4(fetchTexel(texel), fetchTexel(texel + 1), fetchTexel(texel + 2), fetchTexel(texel + 3));
+}
+
+void main()
+{
+    // every instance plays the animation at its own time, blending the two nearest frames
+    float frame = mod((time + instance.w) * frameRate, float(frameCount));
+    int frame0 = int(frame);
+    int frame1 = (frame0 + 1) % frameCount;
+    float blend = frame - float(frame0);
+
+    vec4 totalPosition = vec4(0.0f);
+    if(bakedVertices)
+    {
+        int vertex = vertexOffset + gl_VertexID;
+        totalPosition = mix(fetchTexel(frame0 * texelsPerFrame + vertex), fetchTexel(frame1 * texelsPerFrame + vertex), blend);
+    }
+    else
+    {
+        for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++)
+        {
+            if(boneIds[i] == -1) 
+                continue;
+            mat4 boneMatrix = getBoneMatrix(frame0, boneIds[i]) * (1.0f - blend) + getBoneMatrix(frame1, boneIds[i]) * blend;
+            totalPosition += boneMatrix * vec4(pos,1.0f) * weights[i];
+        }
+    }
+
+    gl_Position =  projection * view * (vec4(instance.xyz, 0.0f) + model * totalPosition);
+	TexCoords = tex;
+}
@@ -0,0 +1,273 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader_m.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/animation_baker.h>
+#include <learnopengl/animator.h>
+#include <learnopengl/model_animation.h>
+
+
+
+#include <chrono>
+#include <iostream>
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// crowd
+const int CROWD_ROWS = 50;
+const int CROWD_COLUMNS = 50;
+
+// baked animation: bone matrices (skinned in the vertex shader) or skinned vertex positions (no skinning left to do)
+const BakeMode BAKE_MODE = BakeMode::BoneMatrices;
+const float BAKE_FRAME_RATE = 30.0f;
+
+// camera
+Camera camera(glm::vec3(0.0f, 2.0f, 10.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+// texture unit of the baked animation, above the units used by the model's textures
+const unsigned int BAKED_ANIMATION_UNIT = 15;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+int main()
+{
+	// glfw: initialize and configure
+	// ------------------------------
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	// glfw window creation
+	// --------------------
+	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetScrollCallback(window, scroll_callback);
+
+	// tell GLFW to capture our mouse
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// glad: load all OpenGL function pointers
+	// ---------------------------------------
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
+	stbi_set_flip_vertically_on_load(true);
+
+	// configure global opengl state
+	// -----------------------------
+	glEnable(GL_DEPTH_TEST);
+
+	// build and compile shaders
+	// -------------------------
+	Shader ourShader("anim_vat.vs", "anim_vat.fs");
+
+	
+	// load models
+	// -----------
+	Model ourModel(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"));
+	Animation danceAnimation(FileSystem::getPath("resources/objects/vampire/dancing_vampire.dae"),&ourModel);
+
+	// bake the animation, or load it from the cache written by a previous run
+	// -----------------------------------------------------------------------
+	auto start = std::chrono::high_resolution_clock::now();
+	const std::string cachePath = BAKE_MODE == BakeMode::BoneMatrices ? "dancing_vampire_bones.vat" : "dancing_vampire_vertices.vat";
+	BakedAnimation bakedAnimation = BakedAnimation::LoadOrBake(cachePath, danceAnimation, BAKE_MODE, BAKE_FRAME_RATE, &ourModel);
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	std::cout << bakedAnimation.GetFrameCount() << " frames at " << bakedAnimation.GetFrameRate() << " fps, "
+		<< bakedAnimation.GetSize() / 1024 << " KB, ready in " << elapsed.count() << " ms" << std::endl;
+
+	// check the baked frames against the Animator, which evaluates the same times
+	if (BAKE_MODE == BakeMode::BoneMatrices)
+	{
+		float maxError = 0.0f;
+		for (int frame = 0; frame < bakedAnimation.GetFrameCount(); frame += 10)
+		{
+			Animator animator(&danceAnimation);
+			animator.UpdateAnimation(frame / bakedAnimation.GetFrameRate());
+			for (int bone = 0; bone < danceAnimation.GetBoneCount(); bone++)
+			{
+				const glm::mat4 difference = animator.GetFinalBoneMatrices()[bone] - bakedAnimation.GetBoneMatrix(frame, bone);
+				for (int column = 0; column < 4; column++)
+					maxError = std::max(maxError, glm::length(difference[column]));
+			}
+		}
+		std::cout << "max difference to the Animator: " << maxError << std::endl;
+	}
+	unsigned int bakedTexture = bakedAnimation.CreateTexture();
+
+	// every character gets its own position and time offset, passed as a per instance attribute
+	// -----------------------------------------------------------------------------------------
+	std::vector<glm::vec4> instances;
+	for (int i = 0; i < CROWD_ROWS * CROWD_COLUMNS; ++i)
+		instances.push_back(glm::vec4((i % CROWD_COLUMNS - CROWD_COLUMNS / 2) * 1.0f, -0.4f, -(i / CROWD_COLUMNS) * 1.0f, i * 0.37f));
+
+	unsigned int instanceBuffer;
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::vec4), &instances[0], GL_STATIC_DRAW);
+	for (unsigned int i = 0; i < ourModel.meshes.size(); i++)
+	{
+		glBindVertexArray(ourModel.meshes[i].VAO);
+		glEnableVertexAttribArray(7);
+		glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+		glVertexAttribDivisor(7, 1);
+		glBindVertexArray(0);
+	}
+
+
+	// draw in wireframe
+	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+	// render loop
+	// -----------
+	while (!glfwWindowShouldClose(window))
+	{
+		// per-frame time logic
+		// --------------------
+		float currentFrame = glfwGetTime();
+		deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		// input
+		// -----
+		processInput(window);
+		
+		// render
+		// ------
+		glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// don't forget to enable shader before setting uniforms
+		ourShader.use();
+
+		// view/projection transformations
+		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+		glm::mat4 view = camera.GetViewMatrix();
+		ourShader.setMat4("projection", projection);
+		ourShader.setMat4("view", view);
+		ourShader.setMat4("model", glm::scale(glm::mat4(1.0f), glm::vec3(.5f, .5f, .5f)));
+		ourShader.setFloat("time", currentFrame);
+
+		// no animation runs on the CPU: the vertex shader reads the frames of every instance from the baked texture
+		glActiveTexture(GL_TEXTURE0 + BAKED_ANIMATION_UNIT);
+		glBindTexture(GL_TEXTURE_2D, bakedTexture);
+		glActiveTexture(GL_TEXTURE0);
+		ourShader.setInt("bakedAnimation", BAKED_ANIMATION_UNIT);
+		ourShader.setInt("texelsPerFrame", bakedAnimation.GetTexelsPerFrame());
+		ourShader.setInt("frameCount", bakedAnimation.GetFrameCount());
+		ourShader.setFloat("frameRate", bakedAnimation.GetFrameRate());
+		ourShader.setBool("bakedVertices", BAKE_MODE == BakeMode::VertexPositions);
+
+		// render the whole crowd with one instanced draw per mesh
+		int vertexOffset = 0;
+		for (unsigned int i = 0; i < ourModel.meshes.size(); i++)
+		{
+			ourShader.setInt("vertexOffset", vertexOffset);
+			ourModel.meshes[i].DrawInstanced(ourShader, static_cast<unsigned int>(instances.size()));
+			vertexOffset += static_cast<int>(ourModel.meshes[i].vertices.size());
+		}
+
+
+		// glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+		// -------------------------------------------------------------------------------
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	glDeleteTextures(1, &bakedTexture);
+	glDeleteBuffers(1, &instanceBuffer);
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+	return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		camera.ProcessKeyboard(FORWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		camera.ProcessKeyboard(BACKWARD, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		camera.ProcessKeyboard(LEFT, deltaTime);
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+	lastX = xpos;
+	lastY = ypos;
+
+	camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	camera.ProcessMouseScroll(yoffset);
+}
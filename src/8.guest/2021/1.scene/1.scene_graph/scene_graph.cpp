@@ -109,8 +109,7 @@ int main()
 
 		for (unsigned int i = 0; i < 10; ++i)
 		{
-			lastEntity->addChild(model);
-			lastEntity = lastEntity->children.back().get();
+			lastEntity = &lastEntity->addChild(model);
 
 			//Set transform values
 			lastEntity->transform.setLocalPosition({ 10, 0, 0 });
@@ -156,7 +155,7 @@ int main()
 		{
 			ourShader.setMat4("model", lastEntity->transform.getModelMatrix());
 			lastEntity->pModel->Draw(ourShader);
-			lastEntity = lastEntity->children.back().get();
+			lastEntity = lastEntity->children.back();
 		}
 
 		ourEntity.transform.setLocalRotation({ 0.f, ourEntity.transform.getLocalRotation().y + 20 * deltaTime, 0.f });
@@ -10,6 +10,7 @@
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
 #include <learnopengl/entity.h>
+#include <learnopengl/scene_renderer.h>
 
 #ifndef ENTITY_H
 #define ENTITY_H
@@ -97,7 +98,7 @@ int main()
 
 	// build and compile shaders
 	// -------------------------
-	Shader ourShader("1.model_loading.vs", "1.model_loading.fs");
+	Shader ourShader("1.model_loading_instanced.vs", "1.model_loading.fs");
 
 	// load entities
 	// -----------
@@ -114,8 +115,7 @@ int main()
 		{
 			for (unsigned int z = 0; z < 20; ++z)
 			{
-				ourEntity.addChild(model);
-				lastEntity = ourEntity.children.back().get();
+				lastEntity = &ourEntity.addChild(model);
 
 				//Set transform values
 				lastEntity->transform.setLocalPosition({ x * 10.f - 100.f,  0.f, z * 10.f - 100.f });
@@ -123,6 +123,10 @@ int main()
 		}
 	}
 	ourEntity.updateSelfAndChild();
+	std::cout << "Entities in pool : " << Entity::pool().liveCount() << " (" << Entity::pool().chunkAllocations() << " chunk allocations)" << std::endl;
+
+	// visible entities are batched per model and drawn with instancing
+	SceneRenderer sceneRenderer;
 
 	// draw in wireframe
 	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -163,9 +167,10 @@ int main()
 		ourShader.setMat4("view", view);
 
 		// draw our scene graph
-		unsigned int total = 0, display = 0;
-		ourEntity.drawSelfAndChild(camFrustum, ourShader, display, total);
-		std::cout << "Total process in CPU : " << total << " / Total send to GPU : " << display << std::endl;
+		sceneRenderer.collect(ourEntity, camFrustum);
+		sceneRenderer.draw(ourShader);
+		std::cout << "Total process in CPU : " << sceneRenderer.getTotalCount() << " / Total send to GPU : " << sceneRenderer.getDisplayCount()
+			<< " / Draw calls : " << sceneRenderer.getDrawCallCount() << std::endl;
 
 		//ourEntity.transform.setLocalRotation({ 0.f, ourEntity.transform.getLocalRotation().y + 20 * deltaTime, 0.f });
 		ourEntity.updateSelfAndChild();
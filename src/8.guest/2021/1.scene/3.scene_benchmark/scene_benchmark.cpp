@@ -0,0 +1,237 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader_m.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/entity.h>
+#include <learnopengl/spatial_hash.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// the transform of a scene graph node as it was computed before the quaternion / affine path: Euler angles turned
+// into three rotation matrices and concatenated with full 4x4 products. only used as the baseline of the benchmark.
+struct EulerNode
+{
+	glm::vec3 position;
+	glm::vec3 eulerRotation;
+	glm::vec3 scale;
+	int parent;
+	glm::mat4 modelMatrix;
+
+	glm::mat4 getLocalModelMatrix() const
+	{
+		const glm::mat4 transformX = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+		const glm::mat4 transformY = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 transformZ = glm::rotate(glm::mat4(1.0f), glm::radians(eulerRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		const glm::mat4 rotationMatrix = transformY * transformX * transformZ;
+		return glm::translate(glm::mat4(1.0f), position) * rotationMatrix * glm::scale(glm::mat4(1.0f), scale);
+	}
+};
+
+// builds a scene graph of 100k entities and times a full update of every world matrix, against the Euler / 4x4
+// matrix baseline over the same hierarchy. also times the update of a graph where nothing moved, which only walks
+// the dirty flags. then moves every entity each frame and reports the update and query throughput of a spatial
+// hash over them.
+// no window is shown, a hidden one only provides the OpenGL context the model needs to load.
+int main()
+{
+	// glfw: initialize and create a hidden window for the context
+	// ------------------------------------------------------------
+	glfwInit();
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+	GLFWwindow* window = glfwCreateWindow(1, 1, "LearnOpenGL", NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	glfwMakeContextCurrent(window);
+
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return -1;
+	}
+
+	// build the scene: a root, 100 groups and 1000 leaves per group
+	// --------------------------------------------------------------
+	const unsigned int groupCount = 100;
+	const unsigned int leavesPerGroup = 1000;
+
+	Model model(FileSystem::getPath("resources/objects/planet/planet.obj"));
+	Entity root(model);
+
+	// same hierarchy and local transforms, parents stored before their children
+	std::vector<EulerNode> eulerNodes;
+	std::vector<Entity*> leaves;
+	eulerNodes.reserve(1 + groupCount * (1 + leavesPerGroup));
+	eulerNodes.push_back({ glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f), -1, glm::mat4(1.0f) });
+
+	for (unsigned int g = 0; g < groupCount; ++g)
+	{
+		const glm::vec3 groupPosition{ (g % 10) * 100.f - 500.f, 0.f, (g / 10) * 100.f - 500.f };
+		const glm::vec3 groupRotation{ 0.f, g * 3.6f, 0.f };
+		Entity& group = root.addChild(model);
+		group.transform.setLocalPosition(groupPosition);
+		group.transform.setLocalRotation(groupRotation);
+		const int groupIndex = static_cast<int>(eulerNodes.size());
+		eulerNodes.push_back({ groupPosition, groupRotation, glm::vec3(1.0f), 0, glm::mat4(1.0f) });
+
+		for (unsigned int l = 0; l < leavesPerGroup; ++l)
+		{
+			const glm::vec3 position{ (l % 32) * 3.f - 48.f, (l % 7) * 1.f, (l / 32) * 3.f - 48.f };
+			const glm::vec3 rotation{ l * 0.5f, l * 1.5f, l * 2.5f };
+			const glm::vec3 scale{ 0.5f + (l % 3) * 0.25f };
+			Entity& leaf = group.addChild(model);
+			leaf.transform.setLocalPosition(position);
+			leaf.transform.setLocalRotation(rotation);
+			leaf.transform.setLocalScale(scale);
+			leaves.push_back(&leaf);
+			eulerNodes.push_back({ position, rotation, scale, groupIndex, glm::mat4(1.0f) });
+		}
+	}
+	const std::size_t nodeCount = eulerNodes.size();
+	std::cout << nodeCount << " nodes, " << Entity::pool().chunkAllocations() << " pool chunk allocations" << std::endl;
+
+	// both paths must agree before they are timed
+	// -------------------------------------------
+	root.forceUpdateSelfAndChild();
+	for (EulerNode& node : eulerNodes)
+		node.modelMatrix = node.parent < 0 ? node.getLocalModelMatrix() : eulerNodes[node.parent].modelMatrix * node.getLocalModelMatrix();
+
+	float maxError = 0.0f;
+	std::size_t nodeIndex = 1;
+	auto compare = [&](const Entity& entity)
+	{
+		const glm::mat4& matrix = entity.transform.getModelMatrix();
+		const glm::mat4& reference = eulerNodes[nodeIndex++].modelMatrix;
+		for (int column = 0; column < 4; ++column)
+			maxError = std::max(maxError, glm::length(matrix[column] - reference[column]));
+	};
+	for (Entity* group : root.children)
+	{
+		compare(*group);
+		for (Entity* leaf : group->children)
+			compare(*leaf);
+	}
+
+	// timings
+	// -------
+	const int iterations = 50;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (EulerNode& node : eulerNodes)
+			node.modelMatrix = node.parent < 0 ? node.getLocalModelMatrix() : eulerNodes[node.parent].modelMatrix * node.getLocalModelMatrix();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+	const double eulerNanoseconds = elapsed.count() * 1e9 / (double(nodeCount) * iterations);
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; ++i)
+		root.forceUpdateSelfAndChild();
+	elapsed = std::chrono::high_resolution_clock::now() - start;
+	const double affineNanoseconds = elapsed.count() * 1e9 / (double(nodeCount) * iterations);
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; ++i)
+		root.updateSelfAndChild();
+	elapsed = std::chrono::high_resolution_clock::now() - start;
+	const double cleanNanoseconds = elapsed.count() * 1e9 / (double(nodeCount) * iterations);
+
+	std::cout << "euler angles, 4x4 products: " << eulerNanoseconds << " ns/node" << std::endl;
+	std::cout << "quaternion, affine products: " << affineNanoseconds << " ns/node (" << eulerNanoseconds / affineNanoseconds
+		<< "x faster), max difference " << maxError << std::endl;
+	std::cout << "nothing dirty: " << cleanNanoseconds << " ns/node" << std::endl;
+
+	// spatial hash: every leaf moves a little every frame
+	// ---------------------------------------------------
+	SpatialHash spatialHash(10.0f, std::size_t(1) << 17);
+	start = std::chrono::high_resolution_clock::now();
+	spatialHash.insertSelfAndChild(root);
+	elapsed = std::chrono::high_resolution_clock::now() - start;
+	std::cout << "spatial hash: " << spatialHash.size() << " entities inserted in " << elapsed.count() * 1e3 << " ms" << std::endl;
+
+	const int frames = 20;
+	double updateSeconds = 0.0;
+	std::size_t cellChanges = 0;
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		for (std::size_t l = 0; l < leaves.size(); ++l)
+		{
+			const float phase = frame * 0.3f + l * 0.01f;
+			const glm::vec3 offset{ std::sin(phase), 0.f, std::cos(phase) };
+			leaves[l]->transform.setLocalPosition(leaves[l]->transform.getLocalPosition() + offset);
+		}
+		root.updateSelfAndChild();
+
+		start = std::chrono::high_resolution_clock::now();
+		spatialHash.update();
+		elapsed = std::chrono::high_resolution_clock::now() - start;
+		updateSeconds += elapsed.count();
+		cellChanges += spatialHash.movedCount();
+	}
+	std::cout << "update: " << leaves.size() * frames / updateSeconds / 1e6 << " M moved entities/s, "
+		<< cellChanges / frames << " cell changes per frame" << std::endl;
+
+	// random queries over the populated area
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> coordinate(-550.f, 550.f);
+	std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+	std::vector<Entity*> found(4096);
+	const int queryCount = 10000;
+
+	std::vector<glm::vec3> queryPoints(queryCount);
+	for (glm::vec3& point : queryPoints)
+		point = { coordinate(random), coordinate(random) * 0.01f, coordinate(random) };
+
+	struct QueryRun { const char* name; std::size_t results; double seconds; };
+	QueryRun queryRuns[] = { { "box 20x20x20", 0, 0.0 }, { "sphere radius 10", 0, 0.0 }, { "ray 200 units", 0, 0.0 } };
+
+	start = std::chrono::high_resolution_clock::now();
+	for (const glm::vec3& point : queryPoints)
+		queryRuns[0].results += spatialHash.queryBox(point - 10.0f, point + 10.0f, found.data(), found.size());
+	queryRuns[0].seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+	for (const glm::vec3& point : queryPoints)
+		queryRuns[1].results += spatialHash.querySphere(point, 10.0f, found.data(), found.size());
+	queryRuns[1].seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+	for (const glm::vec3& point : queryPoints)
+	{
+		const float theta = angle(random);
+		queryRuns[2].results += spatialHash.queryRay(point, { std::cos(theta), 0.f, std::sin(theta) }, 200.0f, found.data(), found.size());
+	}
+	queryRuns[2].seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	for (const QueryRun& run : queryRuns)
+	{
+		std::cout << "query " << run.name << ": " << queryCount / run.seconds / 1e3 << " K queries/s, "
+			<< double(run.results) / queryCount << " entities per query" << std::endl;
+	}
+
+	glfwTerminate();
+	return 0;
+}